@@ -0,0 +1,304 @@
+#include "AssetPack.h"
+
+#include <format>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+
+namespace engine
+{
+	namespace
+	{
+		constexpr uint64_t alignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		template <typename T>
+		void appendBytes(std::vector<std::byte>& buffer, const T& value)
+		{
+			const std::byte* bytes = reinterpret_cast<const std::byte*>(&value);
+			buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+		}
+
+		void appendBytes(std::vector<std::byte>& buffer, const void* data, size_t size)
+		{
+			const std::byte* bytes = static_cast<const std::byte*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+		}
+
+		void padTo(std::vector<std::byte>& buffer, uint64_t alignment)
+		{
+			buffer.resize(alignUp(buffer.size(), alignment));
+		}
+	}
+
+	/**
+	* map pack file and validate header and table of contents
+	*/
+	AssetPack::AssetPack(const std::string_view path)
+		: _file(path)
+	{
+		std::span<const std::byte> data = _file.getData();
+		if (data.size() < sizeof(AssetPackHeader))
+		{
+			throw std::runtime_error(std::format("invalid asset pack, file too small. filename={}", path));
+		}
+
+		const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>(data.data());
+		if (header->magic != magic || header->version != version)
+		{
+			throw std::runtime_error(std::format("unsupported asset pack, magic={:#x}, version={}. filename={}", header->magic, header->version, path));
+		}
+
+		if (header->alignment == 0 || (header->alignment & (header->alignment - 1)) != 0)
+		{
+			throw std::runtime_error(std::format("corrupted asset pack, alignment={}. filename={}", header->alignment, path));
+		}
+
+		/* Bounds are checked by subtraction, offsets read from the file could wrap an addition around */
+		uint64_t tocSize = static_cast<uint64_t>(header->entryCount) * sizeof(AssetEntry);
+		if (header->fileSize != data.size() || header->tocOffset % alignof(AssetEntry) != 0 || header->tocOffset > data.size() || tocSize > data.size() - header->tocOffset)
+		{
+			throw std::runtime_error(std::format("corrupted asset pack table of contents. filename={}", path));
+		}
+
+		_entries = { reinterpret_cast<const AssetEntry*>(data.data() + header->tocOffset), header->entryCount };
+
+		for (const AssetEntry& entry : _entries)
+		{
+			if (entry.offset % header->alignment != 0 || entry.offset > header->tocOffset || entry.size > header->tocOffset - entry.offset)
+			{
+				throw std::runtime_error(std::format("corrupted asset pack entry, name={}. filename={}", std::string_view(entry.name, strnlen(entry.name, sizeof(entry.name))), path));
+			}
+		}
+
+		/* The table of contents is read on every lookup, fault it in up front */
+		_file.prefetch(header->tocOffset, tocSize);
+	}
+
+	/**
+	* find blob by name and type
+	*/
+	std::optional<std::span<const std::byte>> AssetPack::find(const std::string_view name, AssetType type) const
+	{
+		uint64_t hash = hashAssetName(name);
+
+		std::span<const AssetEntry>::iterator it = std::lower_bound(_entries.begin(), _entries.end(), hash, [](const AssetEntry& entry, uint64_t value) {
+			return entry.nameHash < value;
+		});
+
+		for (; it != _entries.end() && it->nameHash == hash; it++)
+		{
+			std::string_view entryName(it->name, strnlen(it->name, sizeof(it->name)));
+			if (entryName == name && it->type == type)
+			{
+				return _file.getData().subspan(it->offset, it->size);
+			}
+		}
+
+		return std::nullopt;
+	}
+
+	/**
+	* find SPIR-V blob, usable as VkShaderModuleCreateInfo::pCode directly
+	*/
+	std::optional<std::span<const uint32_t>> AssetPack::findSpirv(const std::string_view name) const
+	{
+		std::optional<std::span<const std::byte>> blob = find(name, AssetType::Spirv);
+		if (!blob.has_value() || blob->size() % sizeof(uint32_t) != 0)
+		{
+			return std::nullopt;
+		}
+
+		return std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(blob->data()), blob->size() / sizeof(uint32_t));
+	}
+
+	/**
+	* find mesh blob
+	*/
+	std::optional<MeshAsset> AssetPack::findMesh(const std::string_view name) const
+	{
+		std::optional<std::span<const std::byte>> blob = find(name, AssetType::Mesh);
+		if (!blob.has_value() || blob->size() < sizeof(MeshBlobHeader))
+		{
+			return std::nullopt;
+		}
+
+		const MeshBlobHeader* header = reinterpret_cast<const MeshBlobHeader*>(blob->data());
+		if (header->indexType != VK_INDEX_TYPE_UINT16 && header->indexType != VK_INDEX_TYPE_UINT32)
+		{
+			throw std::runtime_error(std::format("corrupted mesh asset, indexType={}, name={}", static_cast<int32_t>(header->indexType), name));
+		}
+
+		uint64_t indexSize = static_cast<uint64_t>(header->indexCount) * (header->indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+		uint64_t vertexSize = static_cast<uint64_t>(header->vertexCount) * header->vertexStride;
+
+		/* Same subtraction form as the table of contents, offsets read from the file could wrap an addition around */
+		if (header->vertexOffset > blob->size() || vertexSize > blob->size() - header->vertexOffset
+			|| header->indexOffset > blob->size() || indexSize > blob->size() - header->indexOffset)
+		{
+			throw std::runtime_error(std::format("corrupted mesh asset, name={}", name));
+		}
+
+		return MeshAsset{
+			.vertices = blob->data() + header->vertexOffset,
+			.vertexCount = header->vertexCount,
+			.vertexStride = header->vertexStride,
+			.indices = header->indexCount == 0 ? nullptr : blob->data() + header->indexOffset,
+			.indexCount = header->indexCount,
+			.indexType = header->indexType,
+		};
+	}
+
+	/**
+	* find texture blob
+	*/
+	std::optional<TextureAsset> AssetPack::findTexture(const std::string_view name) const
+	{
+		std::optional<std::span<const std::byte>> blob = find(name, AssetType::Texture);
+		if (!blob.has_value() || blob->size() < sizeof(TextureBlobHeader))
+		{
+			return std::nullopt;
+		}
+
+		const TextureBlobHeader* header = reinterpret_cast<const TextureBlobHeader*>(blob->data());
+		if (header->dataOffset > blob->size() || header->dataSize > blob->size() - header->dataOffset)
+		{
+			throw std::runtime_error(std::format("corrupted texture asset, name={}", name));
+		}
+
+		return TextureAsset{
+			.extent = { header->width, header->height, 1 },
+			.format = header->format,
+			.data = blob->subspan(header->dataOffset, header->dataSize),
+		};
+	}
+
+	/**
+	* add raw blob
+	*/
+	void AssetPackWriter::add(const std::string_view name, AssetType type, std::span<const std::byte> data)
+	{
+		if (name.size() >= sizeof(AssetEntry::name))
+		{
+			throw std::runtime_error(std::format("asset name too long, name={}", name));
+		}
+
+		_assets.push_back(PendingAsset{
+			.name = std::string(name),
+			.type = type,
+			.data = std::vector<std::byte>(data.begin(), data.end()),
+		});
+	}
+
+	/**
+	* add mesh, indices are stored as 16-bit whenever the vertex count allows
+	*/
+	void AssetPackWriter::addMesh(const std::string_view name, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, std::span<const uint32_t> indices)
+	{
+		bool shortIndices = vertexCount <= 0x10000;
+
+		MeshBlobHeader header{
+			.vertexCount = vertexCount,
+			.vertexStride = vertexStride,
+			.indexCount = static_cast<uint32_t>(indices.size()),
+			.indexType = shortIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32,
+		};
+
+		uint64_t vertexSize = static_cast<uint64_t>(vertexCount) * vertexStride;
+		header.vertexOffset = alignUp(sizeof(MeshBlobHeader), AssetPack::alignment);
+		header.indexOffset = alignUp(header.vertexOffset + vertexSize, AssetPack::alignment);
+
+		std::vector<std::byte> blob;
+		appendBytes(blob, header);
+		padTo(blob, AssetPack::alignment);
+		appendBytes(blob, vertices, vertexSize);
+		padTo(blob, AssetPack::alignment);
+
+		if (shortIndices)
+		{
+			for (uint32_t index : indices)
+			{
+				appendBytes(blob, static_cast<uint16_t>(index));
+			}
+		}
+		else
+		{
+			appendBytes(blob, indices.data(), indices.size_bytes());
+		}
+
+		add(name, AssetType::Mesh, blob);
+	}
+
+	/**
+	* add texture with tightly packed mip 0 texels
+	*/
+	void AssetPackWriter::addTexture(const std::string_view name, uint32_t width, uint32_t height, VkFormat format, std::span<const std::byte> texels)
+	{
+		TextureBlobHeader header{
+			.width = width,
+			.height = height,
+			.format = format,
+			.reserved = 0,
+			.dataOffset = alignUp(sizeof(TextureBlobHeader), AssetPack::alignment),
+			.dataSize = texels.size(),
+		};
+
+		std::vector<std::byte> blob;
+		appendBytes(blob, header);
+		padTo(blob, AssetPack::alignment);
+		appendBytes(blob, texels.data(), texels.size());
+
+		add(name, AssetType::Texture, blob);
+	}
+
+	/**
+	* write pack file
+	*/
+	void AssetPackWriter::write(const std::string_view path) const
+	{
+		std::vector<std::byte> file(alignUp(sizeof(AssetPackHeader), AssetPack::alignment));
+		std::vector<AssetEntry> entries;
+
+		for (const PendingAsset& asset : _assets)
+		{
+			AssetEntry entry{
+				.nameHash = hashAssetName(asset.name),
+				.offset = file.size(),
+				.size = asset.data.size(),
+				.type = asset.type,
+				.reserved = 0,
+				.name = {},
+			};
+			std::memcpy(entry.name, asset.name.data(), asset.name.size());
+			entries.push_back(entry);
+
+			appendBytes(file, asset.data.data(), asset.data.size());
+			padTo(file, AssetPack::alignment);
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const AssetEntry& a, const AssetEntry& b) { return a.nameHash < b.nameHash; });
+
+		AssetPackHeader header{
+			.magic = AssetPack::magic,
+			.version = AssetPack::version,
+			.entryCount = static_cast<uint32_t>(entries.size()),
+			.alignment = AssetPack::alignment,
+			.tocOffset = file.size(),
+			.fileSize = file.size() + entries.size() * sizeof(AssetEntry),
+		};
+
+		appendBytes(file, entries.data(), entries.size() * sizeof(AssetEntry));
+		std::memcpy(file.data(), &header, sizeof(header));
+
+		std::ofstream stream(path.data(), std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", path));
+		}
+
+		stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+	}
+}
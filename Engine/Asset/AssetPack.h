@@ -0,0 +1,162 @@
+#ifndef _ENGINE_ASSET_PACK_HEADER_
+#define _ENGINE_ASSET_PACK_HEADER_
+
+#include <span>
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "MappedFile.h"
+
+namespace engine
+{
+	/**
+	* 64-bit FNV-1a, used to key assets by name
+	*/
+	constexpr uint64_t hashAssetName(const std::string_view name)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (char c : name)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	enum class AssetType : uint32_t
+	{
+		Raw,
+		Mesh,
+		Spirv,
+		Texture,
+	};
+
+	/**
+	* Pack file layout: header, aligned blobs, table of contents sorted by name hash
+	*/
+	struct AssetPackHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t alignment;
+		uint64_t tocOffset;
+		uint64_t fileSize;
+	};
+
+	struct AssetEntry
+	{
+		uint64_t nameHash;
+		uint64_t offset;
+		uint64_t size;
+		AssetType type;
+		uint32_t reserved;
+		char name[48];
+	};
+
+	/**
+	* Mesh blob: header followed by vertex data and index data, both starting on blob alignment
+	*/
+	struct MeshBlobHeader
+	{
+		uint32_t vertexCount;
+		uint32_t vertexStride;
+		uint32_t indexCount;
+		VkIndexType indexType;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+	};
+
+	/**
+	* Texture blob: header followed by tightly packed texels of mip 0
+	*/
+	struct TextureBlobHeader
+	{
+		uint32_t width;
+		uint32_t height;
+		VkFormat format;
+		uint32_t reserved;
+		uint64_t dataOffset;
+		uint64_t dataSize;
+	};
+
+	/**
+	* Views into a mapped pack, valid while the pack stays open
+	*/
+	struct MeshAsset
+	{
+		const void* vertices;
+		uint32_t vertexCount;
+		uint32_t vertexStride;
+		const void* indices;
+		uint32_t indexCount;
+		VkIndexType indexType;
+	};
+
+	struct TextureAsset
+	{
+		VkExtent3D extent;
+		VkFormat format;
+		std::span<const std::byte> data;
+	};
+
+	/**
+	* Versioned binary asset container loaded through a memory mapping
+	* blobs are handed out as spans into the mapping, without intermediate copies
+	*/
+	class AssetPack
+	{
+	public:
+		AssetPack() = default;
+		explicit AssetPack(const std::string_view path);
+
+		std::optional<std::span<const std::byte>> find(const std::string_view name, AssetType type) const;
+		std::optional<std::span<const uint32_t>> findSpirv(const std::string_view name) const;
+		std::optional<MeshAsset> findMesh(const std::string_view name) const;
+		std::optional<TextureAsset> findTexture(const std::string_view name) const;
+
+		std::span<const AssetEntry> getEntries() const { return _entries; }
+		constexpr const bool isOpen() const { return _file.isOpen(); }
+
+		static constexpr uint32_t magic = 0x4B415045; // "EPAK"
+		static constexpr uint32_t version = 1;
+		static constexpr uint32_t alignment = 64;
+
+	protected:
+
+	private:
+		MappedFile _file;
+		std::span<const AssetEntry> _entries;
+	};
+
+	/**
+	* Builds pack files, used by asset tooling
+	*/
+	class AssetPackWriter
+	{
+	public:
+		void add(const std::string_view name, AssetType type, std::span<const std::byte> data);
+		void addMesh(const std::string_view name, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, std::span<const uint32_t> indices);
+		void addTexture(const std::string_view name, uint32_t width, uint32_t height, VkFormat format, std::span<const std::byte> texels);
+
+		void write(const std::string_view path) const;
+
+	protected:
+
+	private:
+		struct PendingAsset
+		{
+			std::string name;
+			AssetType type;
+			std::vector<std::byte> data;
+		};
+
+		std::vector<PendingAsset> _assets;
+	};
+}
+
+#endif // !_ENGINE_ASSET_PACK_HEADER_
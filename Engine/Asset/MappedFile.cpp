@@ -0,0 +1,181 @@
+#include "MappedFile.h"
+
+#include <format>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+namespace engine
+{
+	/**
+	* map file read-only
+	*/
+	MappedFile::MappedFile(const std::string_view path)
+		: _path(path)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", _path));
+		}
+		_file = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			close();
+			throw std::runtime_error(std::format("failed to query file size. filename={}", _path));
+		}
+		_size = static_cast<size_t>(size.QuadPart);
+
+		if (_size == 0)
+		{
+			return;
+		}
+
+		_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_mapping == nullptr)
+		{
+			close();
+			throw std::runtime_error(std::format("failed to create file mapping. filename={}", _path));
+		}
+
+		_data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		_fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (_fd < 0)
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", _path));
+		}
+
+		struct stat status;
+		if (fstat(_fd, &status) != 0)
+		{
+			close();
+			throw std::runtime_error(std::format("failed to query file size. filename={}", _path));
+		}
+		_size = static_cast<size_t>(status.st_size);
+
+		if (_size == 0)
+		{
+			return;
+		}
+
+		void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+		_data = data == MAP_FAILED ? nullptr : data;
+#endif // _WIN32
+
+		if (_data == nullptr)
+		{
+			close();
+			throw std::runtime_error(std::format("failed to map file. filename={}", _path));
+		}
+	}
+
+	/**
+	* unmap file
+	*/
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+
+			_path = std::move(other._path);
+			_data = std::exchange(other._data, nullptr);
+			_size = std::exchange(other._size, 0);
+#ifdef _WIN32
+			_file = std::exchange(other._file, nullptr);
+			_mapping = std::exchange(other._mapping, nullptr);
+#else
+			_fd = std::exchange(other._fd, -1);
+#endif // _WIN32
+		}
+
+		return *this;
+	}
+
+	/**
+	* hint the OS to page in a range ahead of use
+	*/
+	void MappedFile::prefetch(size_t offset, size_t size) const
+	{
+		if (_data == nullptr || offset >= _size)
+		{
+			return;
+		}
+
+		size = std::min(size, _size - offset);
+
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY range{
+			.VirtualAddress = const_cast<char*>(static_cast<const char*>(_data) + offset),
+			.NumberOfBytes = size,
+		};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		/* madvise needs a page aligned address */
+		size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		size_t alignedOffset = offset / pageSize * pageSize;
+		madvise(const_cast<char*>(static_cast<const char*>(_data) + alignedOffset), size + offset - alignedOffset, MADV_WILLNEED);
+#endif // _WIN32
+	}
+
+	/**
+	* release mapping and file handles
+	*/
+	void MappedFile::close()
+	{
+#ifdef _WIN32
+		if (_data != nullptr)
+		{
+			UnmapViewOfFile(_data);
+		}
+		if (_mapping != nullptr)
+		{
+			CloseHandle(_mapping);
+		}
+		if (_file != nullptr)
+		{
+			CloseHandle(_file);
+		}
+		_mapping = nullptr;
+		_file = nullptr;
+#else
+		if (_data != nullptr)
+		{
+			munmap(const_cast<void*>(_data), _size);
+		}
+		if (_fd >= 0)
+		{
+			::close(_fd);
+		}
+		_fd = -1;
+#endif // _WIN32
+
+		_data = nullptr;
+		_size = 0;
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef _ENGINE_MAPPED_FILE_HEADER_
+#define _ENGINE_MAPPED_FILE_HEADER_
+
+#include <span>
+#include <string>
+#include <cstddef>
+
+namespace engine
+{
+	/**
+	* Read-only memory mapping of a whole file
+	* pages are loaded on first access, nothing is copied into the heap
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string_view path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		void prefetch(size_t offset, size_t size) const;
+
+		std::span<const std::byte> getData() const { return { static_cast<const std::byte*>(_data), _size }; }
+		constexpr const size_t getSize() const { return _size; }
+		constexpr const bool isOpen() const { return _data != nullptr; }
+		const std::string& getPath() const { return _path; }
+
+	protected:
+
+	private:
+		std::string _path;
+		const void* _data = nullptr;
+		size_t _size = 0;
+
+#ifdef _WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#else
+		int _fd = -1;
+#endif // _WIN32
+
+		void close();
+	};
+}
+
+#endif // !_ENGINE_MAPPED_FILE_HEADER_
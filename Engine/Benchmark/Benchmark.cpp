@@ -0,0 +1,312 @@
+#include <chrono>
+#include <format>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+
+#include <SDL3/SDL_main.h>
+#include <spdlog/spdlog.h>
+
+#include "../Window/Window.h"
+#include "../Engine/Engine.h"
+#include "../Profile/Profiler.h"
+#include "../IniReader/IniReader.h"
+
+namespace
+{
+	/**
+	* Command line options
+	*/
+	struct Options
+	{
+		bool headless = false;
+		bool serialStartup = true;
+		uint32_t warmupFrames = 60;
+		uint32_t frames = 600;
+		std::vector<uint32_t> objectCounts = { 1'000, 10'000 };
+		std::vector<uint32_t> pipelineCounts = { 1, 8 };
+		std::string output = "benchmark.json";
+	};
+
+	/**
+	* Measured draw scene
+	*/
+	struct SceneResult
+	{
+		engine::DrawScene scene;
+		size_t drawCount;
+		uint64_t frames;
+		double wallTime;
+		engine::FrameMetricSummary metrics[static_cast<size_t>(engine::FrameMetric::Count)];
+	};
+
+	/**
+	* parse comma separated positive integers
+	*/
+	std::vector<uint32_t> parseList(const std::string_view list)
+	{
+		std::vector<uint32_t> values;
+
+		size_t begin = 0;
+		while (begin < list.size())
+		{
+			size_t end = std::min(list.find(',', begin), list.size());
+			int value = std::atoi(std::string(list.substr(begin, end - begin)).c_str());
+			if (value <= 0)
+			{
+				throw std::runtime_error(std::format("invalid list value, list={}", list));
+			}
+
+			values.push_back(static_cast<uint32_t>(value));
+			begin = end + 1;
+		}
+
+		return values;
+	}
+
+	/**
+	* parse command line
+	*/
+	Options parseOptions(int argc, char* argv[])
+	{
+		Options options;
+
+		for (int i = 1; i < argc; i++)
+		{
+			std::string_view argument = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (argument == "--headless")
+			{
+				options.headless = true;
+			}
+			else if (argument == "--parallel-startup")
+			{
+				options.serialStartup = false;
+			}
+			else if (argument == "--warmup" && hasValue)
+			{
+				options.warmupFrames = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0));
+			}
+			else if (argument == "--frames" && hasValue)
+			{
+				/* Percentiles only cover the last FrameStats::capacity frames, measure no more so frames, fps and percentiles share one window */
+				int frames = std::atoi(argv[++i]);
+				options.frames = static_cast<uint32_t>(std::clamp(frames, 1, static_cast<int>(engine::FrameStats::capacity)));
+				if (frames > static_cast<int>(engine::FrameStats::capacity))
+				{
+					spdlog::warn(std::format("frames capped to the frame statistics window, requested={}, frames={}", frames, options.frames));
+				}
+			}
+			else if (argument == "--objects" && hasValue)
+			{
+				options.objectCounts = parseList(argv[++i]);
+			}
+			else if (argument == "--pipelines" && hasValue)
+			{
+				options.pipelineCounts = parseList(argv[++i]);
+			}
+			else if (argument == "--output" && hasValue)
+			{
+				options.output = argv[++i];
+			}
+			else
+			{
+				throw std::runtime_error(std::format("unknown argument, argument={}\n"
+					"usage: Benchmark [--headless] [--parallel-startup] [--warmup N] [--frames N] [--objects N,N] [--pipelines N,N] [--output path]", argument));
+			}
+		}
+
+		return options;
+	}
+
+	/**
+	* render warmup frames, then measure frames of the loaded scene
+	*/
+	SceneResult runScene(engine::Engine* engine, const Options& options, const engine::DrawScene& scene, size_t drawCount)
+	{
+		bool headless = engine->isHeadless();
+
+		for (uint32_t i = 0; i < options.warmupFrames; i++)
+		{
+			if (!headless)
+			{
+				SDL_PumpEvents();
+			}
+			engine->drawFrame();
+		}
+
+		std::unique_ptr<engine::FrameStats> stats = std::make_unique<engine::FrameStats>();
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < options.frames; i++)
+		{
+			std::chrono::steady_clock::time_point frameBegin = std::chrono::steady_clock::now();
+
+			/* A window that is not pumped stops presenting on some platforms */
+			if (!headless)
+			{
+				SDL_PumpEvents();
+			}
+
+			if (engine->drawFrame())
+			{
+				engine::FrameTiming timing = engine->getFrameTiming();
+				timing.cpu = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameBegin).count();
+				stats->push(timing);
+			}
+		}
+		engine->waitIdle();
+
+		SceneResult result{
+			.scene = scene,
+			.drawCount = drawCount,
+			.frames = stats->getFrameCount(),
+			.wallTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(),
+		};
+
+		for (size_t metric = 0; metric < static_cast<size_t>(engine::FrameMetric::Count); metric++)
+		{
+			result.metrics[metric] = stats->summarize(static_cast<engine::FrameMetric>(metric));
+		}
+
+		spdlog::info(std::format("scene objects={}, pipelines={}, instanced={}, frames={}, fps={:.1f}, cpu p50={:.3f}ms, p99={:.3f}ms",
+			scene.objectCount, scene.pipelineCount, scene.instanced, result.frames, result.frames * 1000.0 / result.wallTime,
+			result.metrics[static_cast<size_t>(engine::FrameMetric::Cpu)].p50, result.metrics[static_cast<size_t>(engine::FrameMetric::Cpu)].p99));
+
+		return result;
+	}
+
+	/**
+	* write device, startup stages and scenes as JSON
+	*/
+	void writeJson(const Options& options, engine::Engine* engine, const std::vector<engine::StageTiming>& stages, const std::vector<SceneResult>& scenes)
+	{
+		std::ofstream file(options.output, std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", options.output));
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(engine->getVkPhysicalDevice(), &properties);
+
+		file << "{\n";
+		file << std::format("  \"device\": {{ \"name\": \"{}\", \"api_version\": \"{}.{}.{}\", \"driver_version\": {}, \"headless\": {} }},\n",
+			engine::escapeJson(properties.deviceName), VK_API_VERSION_MAJOR(properties.apiVersion), VK_API_VERSION_MINOR(properties.apiVersion), VK_API_VERSION_PATCH(properties.apiVersion),
+			properties.driverVersion, engine->isHeadless());
+
+		double startupTotal = 0.0;
+		for (const engine::StageTiming& stage : stages)
+		{
+			startupTotal = std::max(startupTotal, stage.begin + stage.duration);
+		}
+
+		file << std::format("  \"startup\": {{ \"serial\": {}, \"total_ms\": {:.4f}, \"stages\": [", options.serialStartup, startupTotal);
+		for (size_t i = 0; i < stages.size(); i++)
+		{
+			const engine::StageTiming& stage = stages[i];
+			file << std::format("{}\n    {{ \"name\": \"{}\", \"thread\": \"{}\", \"skipped\": {}, \"begin_ms\": {:.4f}, \"duration_ms\": {:.4f} }}",
+				i == 0 ? "" : ",", engine::escapeJson(stage.name), stage.thread == engine::StageThread::Main ? "main" : "any", stage.skipped, stage.begin, stage.duration);
+		}
+		file << "\n  ] },\n";
+
+		const char* metricNames[] = { "cpu", "gpu", "acquire", "present" };
+
+		file << "  \"scenes\": [";
+		for (size_t i = 0; i < scenes.size(); i++)
+		{
+			const SceneResult& result = scenes[i];
+			file << std::format("{}\n    {{ \"objects\": {}, \"pipelines\": {}, \"instanced\": {}, \"draws\": {}, \"frames\": {}, \"wall_ms\": {:.4f}, \"fps\": {:.4f}",
+				i == 0 ? "" : ",", result.scene.objectCount, result.scene.pipelineCount, result.scene.instanced, result.drawCount,
+				result.frames, result.wallTime, result.frames * 1000.0 / result.wallTime);
+
+			for (size_t metric = 0; metric < static_cast<size_t>(engine::FrameMetric::Count); metric++)
+			{
+				const engine::FrameMetricSummary& summary = result.metrics[metric];
+				file << std::format(", \"{}\": {{ \"p50_ms\": {:.4f}, \"p95_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"max_ms\": {:.4f}, \"samples\": {} }}",
+					metricNames[metric], summary.p50, summary.p95, summary.p99, summary.max, summary.samples);
+			}
+			file << " }";
+		}
+		file << "\n  ]\n}\n";
+
+		spdlog::info(std::format("wrote benchmark results, path={}, scenes={}", options.output, scenes.size()));
+	}
+}
+
+/**
+* Measure startup stages and draw throughput of scripted scenes, results are written as JSON
+*/
+int main(int argc, char* argv[])
+{
+	Options options;
+	try
+	{
+		options = parseOptions(argc, argv);
+
+		/* Torn down in reverse order by ServiceRegistry::shutdown */
+		ServiceRegistry::registerService<IniReader>();
+		ServiceRegistry::registerService<engine::Profiler>();
+		ServiceRegistry::registerService<engine::Engine>();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
+		ServiceRegistry::shutdown();
+		return EXIT_FAILURE;
+	}
+
+	engine::Engine* engine = engine::Engine::getInstance();
+
+	Window* window = new Window();
+
+	try
+	{
+		window->configure(IniReader::getInstance()->getReader());
+		engine->configure(IniReader::getInstance()->getReader());
+
+		/* Serial startup measures every stage without interference from the others */
+		window->setSerialStartup(options.serialStartup);
+		engine->setHeadless(engine->isHeadless() || options.headless);
+
+		window->init();
+
+		std::vector<SceneResult> results;
+		for (uint32_t objectCount : options.objectCounts)
+		{
+			for (uint32_t pipelineCount : options.pipelineCounts)
+			{
+				for (bool instanced : { false, true })
+				{
+					engine::DrawScene scene{
+						.objectCount = objectCount,
+						.pipelineCount = pipelineCount,
+						.instanced = instanced,
+					};
+
+					engine->loadScene(scene);
+					results.push_back(runScene(engine, options, scene, engine->getDrawCount()));
+				}
+			}
+		}
+
+		writeJson(options, engine, window->getStartupTimings(), results);
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
+		ServiceRegistry::shutdown();
+		return EXIT_FAILURE;
+	}
+
+	ServiceRegistry::shutdown();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,244 @@
+#include <chrono>
+#include <format>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+
+#include <spdlog/spdlog.h>
+
+#include "../Job/JobSystem.h"
+#include "../Render/FrustumCulling.h"
+
+namespace
+{
+	/**
+	* Command line options
+	*/
+	struct Options
+	{
+		uint32_t objects = 1'000'000;
+		uint32_t iterations = 200;
+		uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::string output = "culling_benchmark.json";
+	};
+
+	/**
+	* Throughput of one kernel on a number of threads
+	*/
+	struct CullResult
+	{
+		engine::CullKernel kernel;
+		uint32_t threads;
+		size_t visible;
+		bool matchesScalar;
+		double milliseconds;
+		double objectsPerMillisecond;
+		double objectsPerMillisecondPerCore;
+	};
+
+	/**
+	* parse command line
+	*/
+	Options parseOptions(int argc, char* argv[])
+	{
+		Options options;
+
+		for (int i = 1; i < argc; i++)
+		{
+			std::string_view argument = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (argument == "--objects" && hasValue)
+			{
+				options.objects = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+			}
+			else if (argument == "--iterations" && hasValue)
+			{
+				options.iterations = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+			}
+			else if (argument == "--threads" && hasValue)
+			{
+				options.threads = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+			}
+			else if (argument == "--output" && hasValue)
+			{
+				options.output = argv[++i];
+			}
+			else
+			{
+				throw std::runtime_error(std::format("unknown argument, argument={}\n"
+					"usage: CullingBenchmark [--objects N] [--iterations N] [--threads N] [--output path]", argument));
+			}
+		}
+
+		return options;
+	}
+
+	/**
+	* cull the same spheres iterations times and report the average time per pass, the last pass is compared against the scalar indices
+	*/
+	CullResult measure(engine::FrustumCuller& culler, uint32_t threads, const engine::Frustum& frustum, const engine::SphereBounds& bounds, uint32_t iterations,
+		const std::vector<uint32_t>& reference)
+	{
+		/* One untimed pass sizes the output and warms the caches */
+		std::span<const uint32_t> indices = culler.cull(frustum, bounds);
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			indices = culler.cull(frustum, bounds);
+		}
+		double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / iterations;
+
+		size_t visible = indices.size();
+
+		CullResult result{
+			.kernel = culler.getKernel(),
+			.threads = threads,
+			.visible = visible,
+			.matchesScalar = std::equal(indices.begin(), indices.end(), reference.begin(), reference.end()),
+			.milliseconds = milliseconds,
+			.objectsPerMillisecond = bounds.count / milliseconds,
+			.objectsPerMillisecondPerCore = bounds.count / milliseconds / threads,
+		};
+
+		spdlog::info(std::format("cull kernel={}, threads={}, objects={}, visible={}, time={:.4f}ms, objects/ms/core={:.0f}",
+			engine::getCullKernelName(result.kernel), threads, bounds.count, visible, milliseconds, result.objectsPerMillisecondPerCore));
+
+		if (!result.matchesScalar)
+		{
+			spdlog::error(std::format("cull kernel={}, threads={} disagrees with the scalar kernel, visible={}, scalar visible={}",
+				engine::getCullKernelName(result.kernel), threads, visible, reference.size()));
+		}
+
+		return result;
+	}
+
+	/**
+	* write results as JSON
+	*/
+	void writeJson(const Options& options, const std::vector<CullResult>& results)
+	{
+		std::ofstream file(options.output, std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", options.output));
+		}
+
+		file << std::format("{{\n  \"objects\": {},\n  \"iterations\": {},\n  \"detected_kernel\": \"{}\",\n  \"results\": [",
+			options.objects, options.iterations, engine::getCullKernelName(engine::detectCullKernel()));
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const CullResult& result = results[i];
+			file << std::format("{}\n    {{ \"kernel\": \"{}\", \"threads\": {}, \"visible\": {}, \"matches_scalar\": {}, \"time_ms\": {:.6f}, \"objects_per_ms\": {:.1f}, \"objects_per_ms_per_core\": {:.1f} }}",
+				i == 0 ? "" : ",", engine::getCullKernelName(result.kernel), result.threads, result.visible, result.matchesScalar, result.milliseconds, result.objectsPerMillisecond, result.objectsPerMillisecondPerCore);
+		}
+		file << "\n  ]\n}\n";
+
+		spdlog::info(std::format("wrote culling benchmark results, path={}, results={}", options.output, results.size()));
+	}
+}
+
+/**
+* Measure frustum culling throughput of every kernel the CPU supports, single threaded and on the job system
+*/
+int main(int argc, char* argv[])
+{
+	try
+	{
+		Options options = parseOptions(argc, argv);
+
+		/* Spheres spread around the unit clip volume, roughly a tenth of them are visible */
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> position(-2.0f, 2.0f);
+		std::uniform_real_distribution<float> depth(-1.0f, 2.0f);
+		std::uniform_real_distribution<float> radius(0.001f, 0.05f);
+
+		std::vector<float> centerX(options.objects);
+		std::vector<float> centerY(options.objects);
+		std::vector<float> centerZ(options.objects);
+		std::vector<float> radii(options.objects);
+		for (uint32_t i = 0; i < options.objects; i++)
+		{
+			centerX[i] = position(random);
+			centerY[i] = position(random);
+			centerZ[i] = depth(random);
+			radii[i] = radius(random);
+		}
+
+		engine::SphereBounds bounds{
+			.centerX = centerX.data(),
+			.centerY = centerY.data(),
+			.centerZ = centerZ.data(),
+			.radius = radii.data(),
+			.count = options.objects,
+		};
+
+		const float identity[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f,
+		};
+		engine::Frustum frustum = engine::Frustum::fromViewProjection(identity);
+
+		/* Every kernel has to return exactly the indices of the single threaded scalar kernel, a faster wrong answer is a failure */
+		std::vector<uint32_t> reference;
+		{
+			engine::FrustumCuller scalar;
+			scalar.init(nullptr, engine::CullKernel::Scalar);
+
+			std::span<const uint32_t> indices = scalar.cull(frustum, bounds);
+			reference.assign(indices.begin(), indices.end());
+		}
+
+		engine::JobSystem jobSystem;
+		jobSystem.init(options.threads);
+
+		std::vector<CullResult> results;
+		for (engine::CullKernel kernel : { engine::CullKernel::Scalar, engine::CullKernel::Sse, engine::CullKernel::Avx2 })
+		{
+			if (kernel > engine::detectCullKernel())
+			{
+				continue;
+			}
+
+			engine::FrustumCuller culler;
+
+			culler.init(nullptr, kernel);
+			results.push_back(measure(culler, 1, frustum, bounds, options.iterations, reference));
+
+			if (options.threads > 1)
+			{
+				culler.init(&jobSystem, kernel);
+				results.push_back(measure(culler, options.threads, frustum, bounds, options.iterations, reference));
+			}
+		}
+
+		jobSystem.destroy();
+
+		writeJson(options, results);
+
+		if (std::any_of(results.begin(), results.end(), [](const CullResult& result) { return !result.matchesScalar; }))
+		{
+			spdlog::error(std::format("culling kernels disagree with the scalar kernel, see {}", options.output));
+			return EXIT_FAILURE;
+		}
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,377 @@
+#include <format>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+
+#include <vulkan/vulkan.h>
+#include <spdlog/spdlog.h>
+
+#include "../Memory/MemoryAllocator.h"
+#include "../Render/RenderGraph.h"
+
+namespace
+{
+	/* Exit code ctest reports as skipped, used when no device supports Vulkan 1.3 with synchronization2 */
+	constexpr int skipExitCode = 77;
+
+	constexpr uint32_t framesInFlight = 2;
+	constexpr uint32_t checkedFrames = 3;
+
+	/**
+	* Headless device, no surface or swap chain
+	*/
+	struct Device
+	{
+		VkInstance instance = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkDevice device = VK_NULL_HANDLE;
+		uint32_t queueFamily = 0;
+	};
+
+	/**
+	* Resources of the synthetic frame, rebuilt every frame like Engine::recordFrameGraph does
+	*/
+	struct SyntheticFrame
+	{
+		engine::RenderResource target;
+		engine::RenderResource commands;
+		engine::RenderResource gbuffer;
+		engine::RenderResource lit;
+		engine::RenderResource post;
+		engine::RenderResource unused;
+	};
+
+	/**
+	* create instance and a device with synchronization2, nullopt when no device supports it
+	*/
+	std::optional<Device> createDevice()
+	{
+		Device device;
+
+		VkApplicationInfo appInfo = {
+			.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+			.pApplicationName = "render_graph_check",
+			.pEngineName = "vulkan_engine",
+			.apiVersion = VK_API_VERSION_1_3,
+		};
+
+		VkInstanceCreateInfo instanceInfo = {
+			.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+			.pApplicationInfo = &appInfo,
+		};
+
+		if (vkCreateInstance(&instanceInfo, nullptr, &device.instance) != VK_SUCCESS)
+		{
+			return std::nullopt;
+		}
+
+		uint32_t count = 0;
+		vkEnumeratePhysicalDevices(device.instance, &count, nullptr);
+		std::vector<VkPhysicalDevice> physicalDevices(count);
+		vkEnumeratePhysicalDevices(device.instance, &count, physicalDevices.data());
+
+		for (VkPhysicalDevice physicalDevice : physicalDevices)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+			VkPhysicalDeviceVulkan13Features supported13{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			};
+			VkPhysicalDeviceFeatures2 supported{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &supported13,
+			};
+
+			if (properties.apiVersion < VK_API_VERSION_1_3)
+			{
+				continue;
+			}
+
+			vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+			if (!supported13.synchronization2)
+			{
+				continue;
+			}
+
+			uint32_t familyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+			std::vector<VkQueueFamilyProperties> families(familyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+			for (uint32_t i = 0; i < familyCount; i++)
+			{
+				if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+				{
+					device.physicalDevice = physicalDevice;
+					device.queueFamily = i;
+					spdlog::info(std::format("render graph check device, name={}", properties.deviceName));
+					break;
+				}
+			}
+
+			if (device.physicalDevice != VK_NULL_HANDLE)
+			{
+				break;
+			}
+		}
+
+		if (device.physicalDevice == VK_NULL_HANDLE)
+		{
+			vkDestroyInstance(device.instance, nullptr);
+			return std::nullopt;
+		}
+
+		float queuePriority = 1.0f;
+		VkDeviceQueueCreateInfo queueInfo{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = device.queueFamily,
+			.queueCount = 1,
+			.pQueuePriorities = &queuePriority,
+		};
+
+		VkPhysicalDeviceVulkan13Features vulkan13Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			.synchronization2 = VK_TRUE,
+		};
+
+		VkDeviceCreateInfo deviceInfo{
+			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+			.pNext = &vulkan13Features,
+			.queueCreateInfoCount = 1,
+			.pQueueCreateInfos = &queueInfo,
+		};
+
+		if (vkCreateDevice(device.physicalDevice, &deviceInfo, nullptr, &device.device) != VK_SUCCESS)
+		{
+			vkDestroyInstance(device.instance, nullptr);
+			throw std::runtime_error("failed to create logical device");
+		}
+
+		return device;
+	}
+
+	/**
+	* cull, geometry, lighting, post and composite writing the target, ui drawing on top of it
+	* dead lights an image nothing reads, gbuffer and post never live at the same time
+	*/
+	SyntheticFrame buildFrame(engine::RenderGraph& graph, VkImage targetImage, VkBuffer commandBuffer, std::vector<std::string>& recorded)
+	{
+		SyntheticFrame frame;
+
+		frame.target = graph.importImage("target", targetImage, VK_NULL_HANDLE, VK_IMAGE_ASPECT_COLOR_BIT, engine::AccessInfo{
+			.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.access = VK_ACCESS_2_NONE,
+			.layout = VK_IMAGE_LAYOUT_UNDEFINED,
+		});
+		frame.commands = graph.importBuffer("commands", commandBuffer);
+
+		engine::TransientImageDesc desc{
+			.format = VK_FORMAT_R8G8B8A8_UNORM,
+			.extent = { 256, 256 },
+			.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		};
+		frame.gbuffer = graph.createImage("gbuffer", desc);
+		frame.lit = graph.createImage("lit", desc);
+		frame.post = graph.createImage("post", desc);
+		frame.unused = graph.createImage("unused", desc);
+
+		auto record = [&recorded](const std::string_view name) {
+			return [&recorded, name](VkCommandBuffer, const engine::RenderGraph&) { recorded.emplace_back(name); };
+		};
+
+		uint32_t cull = graph.addPass("cull", record("cull"));
+		graph.write(cull, frame.commands, engine::ResourceAccess::StorageWrite);
+
+		uint32_t geometry = graph.addPass("geometry", record("geometry"));
+		graph.read(geometry, frame.commands, engine::ResourceAccess::IndirectRead);
+		graph.write(geometry, frame.gbuffer, engine::ResourceAccess::ColorAttachmentWrite);
+
+		uint32_t lighting = graph.addPass("lighting", record("lighting"));
+		graph.read(lighting, frame.gbuffer, engine::ResourceAccess::SampledRead);
+		graph.write(lighting, frame.lit, engine::ResourceAccess::ColorAttachmentWrite);
+
+		uint32_t dead = graph.addPass("dead", record("dead"));
+		graph.read(dead, frame.lit, engine::ResourceAccess::SampledRead);
+		graph.write(dead, frame.unused, engine::ResourceAccess::ColorAttachmentWrite);
+
+		uint32_t post = graph.addPass("post", record("post"));
+		graph.read(post, frame.lit, engine::ResourceAccess::SampledRead);
+		graph.write(post, frame.post, engine::ResourceAccess::ColorAttachmentWrite);
+
+		uint32_t composite = graph.addPass("composite", record("composite"));
+		graph.read(composite, frame.post, engine::ResourceAccess::SampledRead);
+		graph.write(composite, frame.target, engine::ResourceAccess::ColorAttachmentWrite);
+
+		uint32_t ui = graph.addPass("ui", record("ui"));
+		graph.read(ui, frame.target, engine::ResourceAccess::ColorAttachmentRead);
+		graph.write(ui, frame.target, engine::ResourceAccess::ColorAttachmentWrite);
+
+		graph.markOutput(frame.target, engine::ResourceAccess::TransferRead);
+
+		return frame;
+	}
+}
+
+/**
+* Compile and record a synthetic frame graph on a headless device and check culling, barrier placement and transient aliasing
+*/
+int main()
+{
+	std::optional<Device> device;
+	try
+	{
+		device = createDevice();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
+		return EXIT_FAILURE;
+	}
+
+	if (!device.has_value())
+	{
+		spdlog::warn(std::format("render graph check skipped, no device supports Vulkan 1.3 with synchronization2"));
+		return skipExitCode;
+	}
+
+	uint32_t failures = 0;
+	auto check = [&failures](bool passed, const std::string& what) {
+		if (!passed)
+		{
+			spdlog::error(std::format("render graph check failed, {}", what));
+			failures++;
+		}
+	};
+
+	try
+	{
+		engine::MemoryAllocator allocator;
+		allocator.init(device->physicalDevice, device->device, 64 * 1024 * 1024);
+
+		VkImageCreateInfo targetInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = VK_FORMAT_R8G8B8A8_UNORM,
+			.extent = { 256, 256, 1 },
+			.mipLevels = 1,
+			.arrayLayers = 1,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		};
+
+		engine::Allocation targetAllocation;
+		VkImage targetImage = allocator.createImage(targetInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, targetAllocation);
+
+		engine::Allocation commandsAllocation;
+		VkBuffer commandsBuffer = allocator.createBuffer(1024, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, commandsAllocation);
+
+		VkCommandPoolCreateInfo poolInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+			.queueFamilyIndex = device->queueFamily,
+		};
+
+		VkCommandPool commandPool;
+		if (vkCreateCommandPool(device->device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create command pool");
+		}
+
+		VkCommandBufferAllocateInfo allocateInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(device->device, &allocateInfo, &commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate command buffer");
+		}
+
+		engine::RenderGraph graph;
+		graph.init(allocator, framesInFlight);
+
+		const std::vector<std::string> expectedPasses = { "cull", "geometry", "lighting", "post", "composite", "ui" };
+
+		/*
+		* gbuffer, lit and post: one transition to attachment and one to sampled each, 6
+		* commands: indirect read after the cull write, 1
+		* target: transition to attachment, ui read after the composite write, transition to transfer source, 3
+		*/
+		constexpr uint32_t expectedBarriers = 10;
+
+		VkImage firstGbuffer = VK_NULL_HANDLE;
+		for (uint32_t frameNumber = 0; frameNumber < checkedFrames; frameNumber++)
+		{
+			std::vector<std::string> recorded;
+
+			graph.beginFrame(frameNumber % framesInFlight);
+			graph.reset();
+			SyntheticFrame frame = buildFrame(graph, targetImage, commandsBuffer, recorded);
+			graph.compile();
+
+			spdlog::info(std::format("render graph frame={}, passes={}, culled={}, barriers={}, transient bytes={}, unaliased bytes={}",
+				frameNumber, graph.getPassCount(), graph.getCulledPassCount(), graph.getBarrierCount(), graph.getTransientBytes(), graph.getUnaliasedBytes()));
+
+			check(graph.getCulledPassCount() == 1, std::format("culled passes, expected=1, actual={}", graph.getCulledPassCount()));
+			check(graph.getImage(frame.unused) == VK_NULL_HANDLE, "image written only by the culled pass was placed");
+			check(graph.getBarrierCount() == expectedBarriers, std::format("barriers, expected={}, actual={}", expectedBarriers, graph.getBarrierCount()));
+			check(graph.getTransientOffset(frame.gbuffer) == graph.getTransientOffset(frame.post),
+				std::format("disjoint transients not aliased, gbuffer offset={}, post offset={}", graph.getTransientOffset(frame.gbuffer), graph.getTransientOffset(frame.post)));
+			check(graph.getTransientOffset(frame.lit) != graph.getTransientOffset(frame.gbuffer), "overlapping transients share an offset");
+			check(graph.getTransientBytes() < graph.getUnaliasedBytes(),
+				std::format("aliasing saved nothing, transient bytes={}, unaliased bytes={}", graph.getTransientBytes(), graph.getUnaliasedBytes()));
+
+			/* The layout is the same every frame, so the transient images have to be reused */
+			firstGbuffer = frameNumber == 0 ? graph.getImage(frame.gbuffer) : firstGbuffer;
+			check(graph.getImage(frame.gbuffer) == firstGbuffer, std::format("transients recreated for an unchanged layout, frame={}", frameNumber));
+
+			VkCommandBufferBeginInfo beginInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+				.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			};
+
+			vkResetCommandBuffer(commandBuffer, 0);
+			vkBeginCommandBuffer(commandBuffer, &beginInfo);
+			graph.execute(commandBuffer);
+			vkEndCommandBuffer(commandBuffer);
+
+			check(recorded == expectedPasses, std::format("recorded passes, frame={}, count={}", frameNumber, recorded.size()));
+		}
+
+		/* Nothing was submitted, the device is idle */
+		graph.destroy();
+		vkDestroyCommandPool(device->device, commandPool, nullptr);
+		allocator.destroyBuffer(commandsBuffer, commandsAllocation);
+		allocator.destroyImage(targetImage, targetAllocation);
+		allocator.destroy();
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
+		failures++;
+	}
+
+	vkDestroyDevice(device->device, nullptr);
+	vkDestroyInstance(device->instance, nullptr);
+
+	if (failures > 0)
+	{
+		spdlog::error(std::format("render graph check failed, failures={}", failures));
+		return EXIT_FAILURE;
+	}
+
+	spdlog::info(std::format("render graph check passed, frames={}", checkedFrames));
+	return EXIT_SUCCESS;
+}
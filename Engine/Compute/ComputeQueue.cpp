@@ -0,0 +1,207 @@
+#include "ComputeQueue.h"
+
+#include <format>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* create timeline semaphore and per batch command pools
+	*/
+	void ComputeQueue::init(VkDevice device, VkQueue queue, uint32_t queueFamily)
+	{
+		_device = device;
+		_queue = queue;
+		_queueFamily = queueFamily;
+
+		VkSemaphoreTypeCreateInfo typeInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = 0,
+		};
+
+		VkSemaphoreCreateInfo semaphoreInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &typeInfo,
+		};
+
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_timelineSemaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create compute timeline semaphore"));
+		}
+
+		_batches.resize(_batchCount);
+		for (ComputeBatch& batch : _batches)
+		{
+			VkCommandPoolCreateInfo poolInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = _queueFamily,
+			};
+
+			if (vkCreateCommandPool(_device, &poolInfo, nullptr, &batch.commandPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create compute command pool"));
+			}
+
+			VkCommandBufferAllocateInfo allocInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = batch.commandPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to allocate compute command buffer"));
+			}
+		}
+
+		spdlog::debug(std::format("created compute queue, family={}", _queueFamily));
+	}
+
+	/**
+	* wait for outstanding work and release resources
+	*/
+	void ComputeQueue::destroy()
+	{
+		if (_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		wait(_submittedValue);
+
+		for (const ComputeBatch& batch : _batches)
+		{
+			vkDestroyCommandPool(_device, batch.commandPool, nullptr);
+		}
+		_batches.clear();
+
+		vkDestroySemaphore(_device, _timelineSemaphore, nullptr);
+		_device = VK_NULL_HANDLE;
+	}
+
+	/**
+	* begin recording compute work, blocks only if the batch slot is still executing
+	*/
+	VkCommandBuffer ComputeQueue::begin()
+	{
+		ComputeBatch& batch = _batches[_currentBatch];
+		if (batch.recording)
+		{
+			return batch.commandBuffer;
+		}
+
+		wait(batch.signalValue);
+		vkResetCommandPool(_device, batch.commandPool, 0);
+
+		VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		};
+
+		if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to begin compute command buffer"));
+		}
+		batch.recording = true;
+
+		/* The batch's previous submission was waited on above, so its timestamps are ready */
+		if (_profiler != nullptr)
+		{
+			_profiler->beginFrame(batch.commandBuffer, _currentBatch);
+		}
+
+		return batch.commandBuffer;
+	}
+
+	/**
+	* submit recorded compute work after the given timeline waits, returns the value it signals
+	*/
+	uint64_t ComputeQueue::submit(std::span<const TimelineWait> waits)
+	{
+		ComputeBatch& batch = _batches[_currentBatch];
+		if (!batch.recording)
+		{
+			return _submittedValue;
+		}
+
+		if (waits.size() > _maxWaits)
+		{
+			throw std::runtime_error(std::format("too many compute waits, count={}", waits.size()));
+		}
+
+		if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to record compute command buffer"));
+		}
+
+		VkSemaphore waitSemaphores[_maxWaits];
+		uint64_t waitValues[_maxWaits];
+		VkPipelineStageFlags waitStages[_maxWaits];
+		for (size_t i = 0; const TimelineWait& timelineWait : waits)
+		{
+			waitSemaphores[i] = timelineWait.semaphore;
+			waitValues[i] = timelineWait.value;
+			waitStages[i] = timelineWait.stageMask;
+			i++;
+		}
+
+		uint64_t signalValue = _submittedValue + 1;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.waitSemaphoreValueCount = static_cast<uint32_t>(waits.size()),
+			.pWaitSemaphoreValues = waitValues,
+			.signalSemaphoreValueCount = 1,
+			.pSignalSemaphoreValues = &signalValue,
+		};
+
+		VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timelineInfo,
+			.waitSemaphoreCount = static_cast<uint32_t>(waits.size()),
+			.pWaitSemaphores = waitSemaphores,
+			.pWaitDstStageMask = waitStages,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &batch.commandBuffer,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &_timelineSemaphore,
+		};
+
+		if (vkQueueSubmit(_queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to submit compute command buffer"));
+		}
+
+		_submittedValue = signalValue;
+		batch.signalValue = signalValue;
+		batch.recording = false;
+		_currentBatch = (_currentBatch + 1) % _batchCount;
+
+		return signalValue;
+	}
+
+	/**
+	* block until the timeline reached value
+	*/
+	void ComputeQueue::wait(uint64_t value) const
+	{
+		if (value == 0)
+		{
+			return;
+		}
+
+		VkSemaphoreWaitInfo waitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &_timelineSemaphore,
+			.pValues = &value,
+		};
+
+		vkWaitSemaphores(_device, &waitInfo, UINT64_MAX);
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef _ENGINE_COMPUTE_QUEUE_HEADER_
+#define _ENGINE_COMPUTE_QUEUE_HEADER_
+
+#include <vector>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include "../Profile/GpuProfiler.h"
+
+namespace engine
+{
+	/**
+	* Compute pipeline and its layout
+	*/
+	struct ComputePipeline
+	{
+		VkPipelineLayout layout = VK_NULL_HANDLE;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+	};
+
+	/**
+	* Cross-queue wait on a timeline semaphore value
+	*/
+	struct TimelineWait
+	{
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t value = 0;
+		VkPipelineStageFlags stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	};
+
+	/**
+	* Command buffer submitted to the compute queue
+	*/
+	struct ComputeBatch
+	{
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		uint64_t signalValue = 0;
+		bool recording = false;
+	};
+
+	/**
+	* Async compute submissions, completion is signaled on a timeline semaphore
+	* resources shared with graphics should use VK_SHARING_MODE_CONCURRENT when the families differ
+	*/
+	class ComputeQueue
+	{
+	public:
+		ComputeQueue() = default;
+		~ComputeQueue() = default;
+
+		ComputeQueue(const ComputeQueue&) = delete;
+		ComputeQueue& operator=(const ComputeQueue&) = delete;
+
+		void init(VkDevice device, VkQueue queue, uint32_t queueFamily);
+		void destroy();
+
+		VkCommandBuffer begin();
+		uint64_t submit(std::span<const TimelineWait> waits = {});
+		void wait(uint64_t value) const;
+
+		void setProfiler(GpuProfiler* profiler) { _profiler = profiler; }
+
+		constexpr const VkSemaphore getTimelineSemaphore() const { return _timelineSemaphore; }
+		constexpr const uint64_t getSubmittedValue() const { return _submittedValue; }
+		constexpr const uint32_t getQueueFamily() const { return _queueFamily; }
+		static constexpr uint32_t getBatchCount() { return _batchCount; }
+
+	protected:
+
+	private:
+		VkDevice _device = VK_NULL_HANDLE;
+		VkQueue _queue = VK_NULL_HANDLE;
+		uint32_t _queueFamily = 0;
+
+		VkSemaphore _timelineSemaphore = VK_NULL_HANDLE;
+		uint64_t _submittedValue = 0;
+
+		std::vector<ComputeBatch> _batches;
+		uint32_t _currentBatch = 0;
+
+		GpuProfiler* _profiler = nullptr;
+
+		static constexpr uint32_t _batchCount = 4;
+		static constexpr uint32_t _maxWaits = 8;
+	};
+}
+
+#endif // !_ENGINE_COMPUTE_QUEUE_HEADER_
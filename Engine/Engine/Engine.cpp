@@ -4,6 +4,13 @@
 #include <format>
 #include <map>
 #include <set>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <algorithm>
+#include <numeric>
 
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_vulkan.h>
@@ -13,19 +20,16 @@
 namespace engine
 {
 	/**
-	* Initialize external libraries
+	* Initialize external libraries, SDL is initialized by the startup graph
 	*/
 	Engine::Engine()
 	{
+		_startupBegin = std::chrono::steady_clock::now();
+
 		/* Spdlog configuration */
 		spdlog::set_level(spdlog::level::debug);
 
-		/* SDL Initialization */
 		spdlog::debug(std::format("initializing engine resources"));
-		if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
-		{
-			throw std::runtime_error(std::format("Failed to initialize SDL library, {}", SDL_GetError()));
-		}
 	}
 
 	/**
@@ -35,9 +39,189 @@ namespace engine
 	{
 		spdlog::debug(std::format("destroying engine resources"));
 		destroyInstance();
+		if (!_headless)
+		{
+			SDL_Vulkan_UnloadLibrary();
+		}
 		SDL_Quit();
 	}
 
+	/**
+	* apply the [engine] section of the config, has to happen before startup
+	*/
+	void Engine::configure(const INIReader& reader)
+	{
+		setAssetPackPath(reader.GetString("engine", "asset_pack", ""));
+		setShaderHotReload(reader.GetBoolean("engine", "shader_hot_reload", false));
+		setShaderSourceDirectory(reader.GetString("engine", "shader_source_dir", "resources/shader"));
+		setShaderCompiler(reader.GetString("engine", "shader_compiler", "glslc"));
+		setVertexLayout(VertexFormat::parseLayout(reader.GetString("engine", "vertex_layout", "interleaved")));
+		setStagingBufferSize(parseMegabytes(reader.GetInteger("engine", "staging_buffer_mb", 32)));
+		setMemoryBlockSize(parseMegabytes(reader.GetInteger("engine", "memory_block_mb", 64)));
+		setFrameAllocatorSize(parseMegabytes(reader.GetInteger("engine", "frame_allocator_mb", 16)));
+		setPipelineCachePath(reader.GetString("engine", "pipeline_cache", "pipeline_cache.bin"));
+		setSDLSubsystems(parseSDLSubsystems(reader.GetString("engine", "sdl_subsystems", "video")));
+		setJobThreads(reader.GetInteger("engine", "job_threads", 0));
+		setRecordBenchmarkDraws(reader.GetInteger("engine", "record_benchmark_draws", 0));
+		setProfilerEnabled(reader.GetBoolean("engine", "profiler", false));
+		setProfileTracePath(reader.GetString("engine", "profile_trace", "profile_trace.json"));
+		setProfileFrames(reader.GetInteger("engine", "profile_frames", 120));
+		setFramesInFlight(reader.GetInteger("engine", "frames_in_flight", 2));
+		setHeadless(reader.GetBoolean("engine", "headless", false));
+		setFrustumCulling(reader.GetBoolean("engine", "frustum_culling", false));
+		setCullKernel(parseCullKernel(reader.GetString("engine", "cull_kernel", "auto")));
+		setGpuDriven(reader.GetBoolean("engine", "gpu_driven", false));
+		setDynamicRendering(reader.GetBoolean("engine", "dynamic_rendering", true));
+	}
+
+	/**
+	* initialize SDL video and load the Vulkan loader, so instance creation does not wait for a window
+	* headless runs use neither SDL video nor its loader, Vulkan is linked directly
+	*/
+	void Engine::initSDL()
+	{
+		if (_headless)
+		{
+			return;
+		}
+
+		if (SDL_Init(_sdlSubsystems & (SDL_INIT_VIDEO | SDL_INIT_EVENTS)) != 0)
+		{
+			throw std::runtime_error(std::format("Failed to initialize SDL library, {}", SDL_GetError()));
+		}
+
+		if (SDL_Vulkan_LoadLibrary(nullptr) != 0)
+		{
+			throw std::runtime_error(std::format("failed to load Vulkan library, {}", SDL_GetError()));
+		}
+	}
+
+	/**
+	* initialize the remaining configured SDL subsystems
+	*/
+	void Engine::initSDLSubsystems()
+	{
+		/* Headless runs skipped initSDL, so events are initialized here as well */
+		Uint32 subsystems = _sdlSubsystems & ~(_headless ? SDL_INIT_VIDEO : (SDL_INIT_VIDEO | SDL_INIT_EVENTS));
+		if (subsystems == 0)
+		{
+			return;
+		}
+
+		if (SDL_InitSubSystem(subsystems) != 0)
+		{
+			throw std::runtime_error(std::format("failed to initialize SDL subsystems, {}", SDL_GetError()));
+		}
+	}
+
+	/**
+	* parse comma separated SDL subsystem names, video is always initialized
+	*/
+	Uint32 Engine::parseSDLSubsystems(const std::string_view subsystems)
+	{
+		const std::map<std::string_view, Uint32> names = {
+			{ "video", SDL_INIT_VIDEO },
+			{ "events", SDL_INIT_EVENTS },
+			{ "audio", SDL_INIT_AUDIO },
+			{ "timer", SDL_INIT_TIMER },
+			{ "joystick", SDL_INIT_JOYSTICK },
+			{ "haptic", SDL_INIT_HAPTIC },
+			{ "sensor", SDL_INIT_SENSOR },
+		};
+
+		Uint32 flags = SDL_INIT_VIDEO;
+
+		size_t begin = 0;
+		while (begin < subsystems.size())
+		{
+			size_t end = std::min(subsystems.find(',', begin), subsystems.size());
+			std::string_view name = subsystems.substr(begin, end - begin);
+
+			name.remove_prefix(std::min(name.find_first_not_of(' '), name.size()));
+			name.remove_suffix(name.size() - std::min(name.find_last_not_of(' ') + 1, name.size()));
+
+			if (!name.empty())
+			{
+				std::map<std::string_view, Uint32>::const_iterator it = names.find(name);
+				if (it == names.end())
+				{
+					throw std::runtime_error(std::format("unknown SDL subsystem, name={}", name));
+				}
+				flags |= it->second;
+			}
+
+			begin = end + 1;
+		}
+
+		return flags;
+	}
+
+	/**
+	* size in bytes of a megabyte count from the config, at least one megabyte
+	*/
+	VkDeviceSize Engine::parseMegabytes(long megabytes)
+	{
+		/* long is 32 bits on Windows, shift in VkDeviceSize so 2048 and more don't overflow */
+		return static_cast<VkDeviceSize>(std::max(megabytes, 1L)) << 20;
+	}
+
+	/**
+	* start job threads, one per core unless configured
+	*/
+	void Engine::createJobSystem()
+	{
+		_jobSystem.init(_jobThreads > 0 ? _jobThreads : std::max(std::thread::hardware_concurrency(), 1u));
+		_culler.init(&_jobSystem, _cullKernel);
+
+		spdlog::debug(std::format("frustum culling, enabled={}, kernel={}", _frustumCulling, getCullKernelName(_culler.getKernel())));
+	}
+
+	/**
+	* start collecting CPU scopes, has to be called on the main thread
+	*/
+	void Engine::createProfiler()
+	{
+		if (!_profilerEnabled)
+		{
+			return;
+		}
+
+		/* Keep a little more than the exported range, so its first frame is complete */
+		_profiler = &ServiceRegistry::get<Profiler>();
+		_profiler->init(_profileFrames + _framesInFlight);
+	}
+
+	/**
+	* map asset pack, assets missing from the pack fall back to loose files
+	*/
+	void Engine::openAssetPack()
+	{
+		if (_assetPackPath.empty())
+		{
+			return;
+		}
+
+		_assetPack = AssetPack(_assetPackPath);
+
+		spdlog::debug(std::format("opened asset pack, path={}, entries={}", _assetPackPath, _assetPack.getEntries().size()));
+	}
+
+	/**
+	* start watching shader sources in development mode, shaders are otherwise served from the embedded table
+	*/
+	void Engine::createShaderLibrary()
+	{
+		if (_shaderHotReload)
+		{
+			_shaderLibrary.enableHotReload(_shaderSourceDirectory, _shaderCompiler, &_jobSystem);
+		}
+
+		for (const EmbeddedShader& shader : embeddedShaders)
+		{
+			spdlog::debug(std::format("embedded shader, name={}, words={}, hash={:016x}", shader.name, shader.code.size(), shader.hash));
+		}
+	}
+
 	/**
 	* create Vulkan instance
 	*/
@@ -133,10 +317,31 @@ namespace engine
 	}
 
 	/**
-	* create VkSurface
+	* create VkSurface, a VK_EXT_headless_surface in headless mode
 	*/
 	void Engine::createSurface()
 	{
+		if (_headless)
+		{
+			PFN_vkCreateHeadlessSurfaceEXT func = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(_instance, "vkCreateHeadlessSurfaceEXT");
+			if (func == nullptr)
+			{
+				throw std::runtime_error(std::format("failed to create VkSurface: {} not present", VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME));
+			}
+
+			VkHeadlessSurfaceCreateInfoEXT createInfo{
+				.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT,
+			};
+
+			if (func(_instance, &createInfo, nullptr, &_surface) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create headless VkSurface"));
+			}
+
+			spdlog::info(std::format("created headless surface, extent={}x{}", _headlessExtent.width, _headlessExtent.height));
+			return;
+		}
+
 		if (SDL_Vulkan_CreateSurface(_window, _instance, &_surface) != SDL_TRUE) {
 			throw std::runtime_error(std::format("failed to create VkSurface: {}", SDL_GetError()));
 		}
@@ -174,6 +379,14 @@ namespace engine
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+		if (indices.transferFamily.has_value())
+		{
+			uniqueQueueFamilies.insert(indices.transferFamily.value());
+		}
+		if (indices.computeFamily.has_value())
+		{
+			uniqueQueueFamilies.insert(indices.computeFamily.value());
+		}
 
 		float queuePriority = 1.0f;
 		for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -190,9 +403,72 @@ namespace engine
 
 		VkPhysicalDeviceFeatures deviceFeatures{};
 
+		/* Descriptor indexing backs the bindless heap, it and timeline semaphores were checked by isDeviceSuitable when the device was picked */
+		VkPhysicalDeviceVulkan12Features vulkan12Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+			.descriptorIndexing = VK_TRUE,
+			.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+			.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+			.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+			.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+			.descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+			.descriptorBindingPartiallyBound = VK_TRUE,
+			.runtimeDescriptorArray = VK_TRUE,
+			.timelineSemaphore = VK_TRUE,
+		};
+
+		/* GPU driven draws need a device side draw count and one indirect draw covering many objects */
+		if (_gpuDriven)
+		{
+			VkPhysicalDeviceVulkan12Features supported12{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+			};
+
+			VkPhysicalDeviceFeatures2 supported{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &supported12,
+			};
+
+			vkGetPhysicalDeviceFeatures2(_physicalDevice, &supported);
+
+			if (supported12.drawIndirectCount && supported.features.multiDrawIndirect && supported.features.drawIndirectFirstInstance)
+			{
+				vulkan12Features.drawIndirectCount = VK_TRUE;
+				deviceFeatures.multiDrawIndirect = VK_TRUE;
+				deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
+			}
+			else
+			{
+				spdlog::warn(std::format("gpu driven rendering is not supported, falling back to recorded draws, drawIndirectCount={}, multiDrawIndirect={}, drawIndirectFirstInstance={}",
+					supported12.drawIndirectCount == VK_TRUE, supported.features.multiDrawIndirect == VK_TRUE, supported.features.drawIndirectFirstInstance == VK_TRUE));
+				_gpuDriven = false;
+			}
+		}
+
+		/* Dynamic rendering replaces render pass and framebuffers, its layout transitions are synchronization2 barriers */
+		VkPhysicalDeviceVulkan13Features vulkan13Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			.synchronization2 = VK_TRUE,
+			.dynamicRendering = VK_TRUE,
+		};
+
+		if (_dynamicRendering)
+		{
+			if (checkDynamicRenderingSupport(_physicalDevice))
+			{
+				vulkan12Features.pNext = &vulkan13Features;
+			}
+			else
+			{
+				spdlog::warn(std::format("dynamic rendering is not supported, falling back to render pass and framebuffers"));
+				_dynamicRendering = false;
+			}
+		}
+
 		VkDeviceCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-			.queueCreateInfoCount = 1,
+			.pNext = &vulkan12Features,
+			.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
 			.pQueueCreateInfos = queueCreateInfos.data(),
 			.enabledExtensionCount = static_cast<uint32_t>(_deviceExtensions.size()),
 			.ppEnabledExtensionNames = _deviceExtensions.data(),
@@ -215,6 +491,127 @@ namespace engine
 		}
 
 		vkGetDeviceQueue(_device, indices.graphicsFamily.value(), 0, &_graphicsQueue);
+		vkGetDeviceQueue(_device, indices.presentFamily.value(), 0, &_presentQueue);
+
+		/* Without a transfer-only family uploads share the graphics queue */
+		if (indices.transferFamily.has_value())
+		{
+			vkGetDeviceQueue(_device, indices.transferFamily.value(), 0, &_transferQueue);
+		}
+		else
+		{
+			_transferQueue = _graphicsQueue;
+		}
+
+		/* Without a separate compute family async compute work is serialized on the graphics queue */
+		if (indices.computeFamily.has_value())
+		{
+			vkGetDeviceQueue(_device, indices.computeFamily.value(), 0, &_computeQueueHandle);
+		}
+		else
+		{
+			_computeQueueHandle = _graphicsQueue;
+		}
+
+		_queueFamilyIndicies = indices;
+
+		spdlog::debug(std::format("queue families: graphics={}, present={}, transfer={}, compute={}",
+			indices.graphicsFamily.value(), indices.presentFamily.value(),
+			indices.transferFamily.has_value() ? std::to_string(indices.transferFamily.value()) : "shared",
+			indices.computeFamily.has_value() ? std::to_string(indices.computeFamily.value()) : "shared"));
+	}
+
+	/**
+	* create device memory allocator
+	*/
+	void Engine::createMemoryAllocator()
+	{
+		_memoryAllocator.init(_physicalDevice, _device, _memoryBlockSize);
+	}
+
+	/**
+	* create upload queue on the transfer queue
+	*/
+	void Engine::createUploadQueue()
+	{
+		uint32_t graphicsFamily = _queueFamilyIndicies.graphicsFamily.value();
+		uint32_t transferFamily = _queueFamilyIndicies.transferFamily.value_or(graphicsFamily);
+
+		_uploadQueue.init(_memoryAllocator, _transferQueue, transferFamily, graphicsFamily, _stagingBufferSize);
+	}
+
+	/**
+	* create async compute queue
+	*/
+	void Engine::createComputeQueue()
+	{
+		uint32_t computeFamily = _queueFamilyIndicies.computeFamily.value_or(_queueFamilyIndicies.graphicsFamily.value());
+
+		_computeQueue.init(_device, _computeQueueHandle, computeFamily);
+	}
+
+	/**
+	* create timestamp query rings, the graphics queue is always timed for frame statistics, compute only while profiling
+	*/
+	void Engine::createGpuProfilers()
+	{
+		uint32_t graphicsFamily = _queueFamilyIndicies.graphicsFamily.value();
+		uint32_t computeFamily = _queueFamilyIndicies.computeFamily.value_or(graphicsFamily);
+
+		/* One slot per frame in flight, the frame fence guarantees the slot finished before it is reused */
+		_graphicsProfiler.init(_profiler, _physicalDevice, _device, _graphicsQueue, graphicsFamily, _framesInFlight, "graphics queue");
+
+		if (_profiler == nullptr)
+		{
+			return;
+		}
+
+		/* Compute work shares the graphics queue without a separate family, it still gets its own track */
+		_computeProfiler.init(_profiler, _physicalDevice, _device, _computeQueueHandle, computeFamily, ComputeQueue::getBatchCount(), _computeQueueHandle != _graphicsQueue ? "compute queue" : "compute on graphics queue");
+		_computeQueue.setProfiler(&_computeProfiler);
+	}
+
+	/**
+	* read pipeline cache blob from disk, it is validated once the physical device is known
+	*/
+	void Engine::loadPipelineCacheData()
+	{
+		if (std::filesystem::exists(_pipelineCachePath))
+		{
+			_pipelineCacheData = readFile(_pipelineCachePath);
+		}
+	}
+
+	/**
+	* create pipeline cache, seeded with the loaded blob when it matches the device
+	*/
+	void Engine::createPipelineCache()
+	{
+		std::vector<char> initialData = std::move(_pipelineCacheData);
+
+		if (!initialData.empty())
+		{
+			if (!isPipelineCacheCompatible(initialData))
+			{
+				spdlog::warn(std::format("discarding stale pipeline cache, path={}", _pipelineCachePath));
+				initialData.clear();
+			}
+		}
+
+		VkPipelineCacheCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = initialData.size(),
+			.pInitialData = initialData.empty() ? nullptr : initialData.data(),
+		};
+
+		if (vkCreatePipelineCache(_device, &createInfo, nullptr, &_pipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create pipeline cache"));
+		}
+
+		_pipelineCacheWarm = !initialData.empty();
+
+		spdlog::debug(std::format("created pipeline cache, path={}, size={}, warm={}", _pipelineCachePath, initialData.size(), _pipelineCacheWarm));
 	}
 
 	/**
@@ -266,13 +663,21 @@ namespace engine
 		createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;
-		createInfo.oldSwapchain = VK_NULL_HANDLE;
+		/* Hand the retired swap chain over so the presentation engine can reuse its resources */
+		VkSwapchainKHR oldSwapchain = _swapchain;
+		createInfo.oldSwapchain = oldSwapchain;
 
 		if (vkCreateSwapchainKHR(_device, &createInfo, nullptr, &_swapchain) != VK_SUCCESS)
 		{
+			_swapchain = oldSwapchain;
 			throw std::runtime_error(std::format("failed to create swap chain"));
 		}
 
+		if (oldSwapchain != VK_NULL_HANDLE)
+		{
+			vkDestroySwapchainKHR(_device, oldSwapchain, nullptr);
+		}
+
 		vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, nullptr);
 		_swapChainImages.resize(imageCount);
 		vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, _swapChainImages.data());
@@ -314,14 +719,21 @@ namespace engine
 			{
 				throw std::runtime_error(std::format("failed to create image view"));
 			}
+
+			i++;
 		}
 	}
 
 	/**
-	* create render pass
+	* create render pass, dynamic rendering needs none
 	*/
 	void Engine::createRenderPass()
 	{
+		if (_dynamicRendering)
+		{
+			return;
+		}
+
 		VkAttachmentDescription colorAttachment{
 			.format = _swapChainImageFormat,
 			.samples = VK_SAMPLE_COUNT_1_BIT,
@@ -344,12 +756,24 @@ namespace engine
 			.pColorAttachments = &colorAttachmentRef,
 		};
 
+		/* Wait for the acquired swap chain image before writing color output */
+		VkSubpassDependency dependency{
+			.srcSubpass = VK_SUBPASS_EXTERNAL,
+			.dstSubpass = 0,
+			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		};
+
 		VkRenderPassCreateInfo renderPassInfo{
 			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
 			.attachmentCount = 1,
 			.pAttachments = &colorAttachment,
 			.subpassCount = 1,
 			.pSubpasses = &subpass,
+			.dependencyCount = 1,
+			.pDependencies = &dependency,
 		};
 
 		if (vkCreateRenderPass(_device, &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS)
@@ -359,15 +783,79 @@ namespace engine
 	}
 
 	/**
-	* create graphics pipeline
+	* create the global bindless descriptor set, its layout is the only set layout of the graphics pipelines
 	*/
-	void Engine::createGraphicsPipeline()
+	void Engine::createBindlessHeap()
+	{
+		_bindlessHeap.init(_physicalDevice, _device, _framesInFlight);
+	}
+
+	/**
+	* create a persistently mapped linear allocator per frame in flight and make each frame's buffer visible to shaders
+	*/
+	void Engine::createFrameAllocator()
+	{
+		_frameAllocator.init(_memoryAllocator, _frameAllocatorSize, _framesInFlight);
+
+		_frameAllocatorIndices.clear();
+		for (uint32_t i = 0; i < _framesInFlight; i++)
+		{
+			_frameAllocatorIndices.push_back(_bindlessHeap.registerBuffer(_frameAllocator.getBuffer(i)));
+		}
+
+		spdlog::debug(std::format("created frame allocator, frames={}, capacity={}, alignment={}",
+			_framesInFlight, _frameAllocator.getCapacity(), _frameAllocator.getAlignment()));
+	}
+
+	/**
+	* create the render graph frames are recorded through, it needs synchronization2 so the render pass path goes without
+	*/
+	void Engine::createRenderGraph()
+	{
+		if (!_dynamicRendering)
+		{
+			return;
+		}
+
+		_renderGraph.init(_memoryAllocator, _framesInFlight);
+	}
+
+	/**
+	* create render queue
+	*/
+	void Engine::createRenderQueue()
+	{
+		_renderQueue.init(&_jobSystem);
+	}
+
+	/**
+	* create indirect renderer and its cull pipeline, only when GPU driven rendering is enabled and supported
+	*/
+	void Engine::createIndirectRenderer()
 	{
-		std::vector<char> vertShaderCode = readFile("shader/vertex.spv");
-		std::vector<char> fragShaderCode = readFile("shader/fragment.spv");
+		if (!_gpuDriven)
+		{
+			return;
+		}
+
+		_indirectRenderer.init(_memoryAllocator, _bindlessHeap, _framesInFlight);
+
+		VkPushConstantRange pushConstantRange{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset = 0,
+			.size = sizeof(CullConstants),
+		};
+
+		_indirectRenderer.setCullPipeline(&createComputePipeline("shader/cull.spv", { _indirectRenderer.getSetLayout() }, { pushConstantRange }));
+	}
 
-		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+	/**
+	* create graphics pipeline, GPU driven rendering reads object data through the indirect renderer's set
+	*/
+	void Engine::createGraphicsPipeline()
+	{
+		VkShaderModule vertShaderModule = loadShaderModule(_gpuDriven ? "shader/vertex_indirect.spv" : "shader/vertex.spv");
+		VkShaderModule fragShaderModule = loadShaderModule("shader/fragment.spv");
 
 		VkPipelineShaderStageCreateInfo vertShaderCreateInfo{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
@@ -396,13 +884,12 @@ namespace engine
 			.pDynamicStates = dynamicStates.data(),
 		};
 
-		VkPipelineVertexInputStateCreateInfo vertexInputInfo{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-			.vertexBindingDescriptionCount = 0,
-			.pVertexBindingDescriptions = nullptr,
-			.vertexAttributeDescriptionCount = 0,
-			.pVertexAttributeDescriptions = nullptr,
-		};
+		_vertexFormat = VertexFormat({
+			{ VertexSemantic::Position, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+			{ VertexSemantic::Color, VK_FORMAT_R32G32B32_SFLOAT, 1 },
+		}, _vertexLayout);
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = _vertexFormat.getInputState();
 
 		VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
@@ -478,12 +965,20 @@ namespace engine
 			},
 		};
 
+		/* Resources are reached through the bindless set, the push constants say which of them a draw uses */
+		VkDescriptorSetLayout setLayout = _bindlessHeap.getSetLayout();
+		VkPushConstantRange pushConstantRange{
+			.stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+			.offset = 0,
+			.size = sizeof(DrawConstants),
+		};
+
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-			.setLayoutCount = 0,
-			.pSetLayouts = nullptr,
-			.pushConstantRangeCount = 0,
-			.pPushConstantRanges = nullptr,
+			.setLayoutCount = 1,
+			.pSetLayouts = &setLayout,
+			.pushConstantRangeCount = 1,
+			.pPushConstantRanges = &pushConstantRange,
 		};
 
 		if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS)
@@ -509,20 +1004,382 @@ namespace engine
 			.basePipelineIndex = -1,
 		};
 
-		if (vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS)
+		/* Without a render pass the pipeline only has to know the attachment formats */
+		VkPipelineRenderingCreateInfo renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &_swapChainImageFormat,
+		};
+
+		if (_dynamicRendering)
+		{
+			pipelineInfo.pNext = &renderingInfo;
+		}
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+		if (vkCreateGraphicsPipelines(_device, _pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS)
 		{
 			throw std::runtime_error(std::format("failed to create graphics pipeline"));
 		}
 
+		/* Scenes with several pipelines get identical but distinct pipeline objects, so every switch is a real bind */
+		if (_scene.pipelineCount > 1)
+		{
+			std::vector<VkGraphicsPipelineCreateInfo> variantInfos(_scene.pipelineCount - 1, pipelineInfo);
+			_pipelineVariants.resize(variantInfos.size());
+
+			if (vkCreateGraphicsPipelines(_device, _pipelineCache, static_cast<uint32_t>(variantInfos.size()), variantInfos.data(), nullptr, _pipelineVariants.data()) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create graphics pipeline variants, count={}", variantInfos.size()));
+			}
+		}
+
+		/* Render items name pipelines by their index in this list */
+		std::vector<VkPipeline> pipelines = { _pipeline };
+		pipelines.insert(pipelines.end(), _pipelineVariants.begin(), _pipelineVariants.end());
+		_renderQueue.setPipelines(std::move(pipelines));
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+		spdlog::info(std::format("created graphics pipeline in {:.3f}ms, cache={}", elapsed.count(), _pipelineCacheWarm ? "warm" : "cold"));
+
 		vkDestroyShaderModule(_device, vertShaderModule, nullptr);
 		vkDestroyShaderModule(_device, fragShaderModule, nullptr);
 	}
 
 	/**
-	*	create vkFrameBuffer
+	* create scene geometry
+	*/
+	void Engine::createGeometry()
+	{
+		/* Interleaved position and color, laid out as _vertexFormat's source */
+		const float vertices[] = {
+			0.0f, -0.5f, 0.0f,		1.0f, 0.0f, 0.0f,
+			0.5f, 0.5f, 0.0f,		0.0f, 1.0f, 0.0f,
+			-0.5f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,
+		};
+		const uint32_t indices[] = { 0, 1, 2 };
+
+		std::optional<MeshAsset> meshAsset = _assetPack.isOpen() ? _assetPack.findMesh("mesh/triangle") : std::nullopt;
+		if (meshAsset.has_value())
+		{
+			_mesh = createMesh(_memoryAllocator, _uploadQueue, _vertexFormat, meshAsset.value());
+		}
+		else
+		{
+			_mesh = createMesh(_memoryAllocator, _uploadQueue, _vertexFormat, vertices, 3, indices);
+		}
+
+		spdlog::debug(std::format("created mesh, vertices={}, indices={}, streams={}, indexType={}",
+			_mesh.vertexCount, _mesh.indexCount, _mesh.vertexBufferCount, _mesh.indexType == VK_INDEX_TYPE_UINT16 ? "uint16" : "uint32"));
+
+		populateScene();
+		buildDrawList();
+	}
+
+	/**
+	* switch to a scripted scene, pipelines are only rebuilt when the pipeline count changes
+	*/
+	void Engine::loadScene(const DrawScene& scene)
+	{
+		DrawScene previous = _scene;
+		_scene = DrawScene{
+			.objectCount = std::max(scene.objectCount, 1u),
+			.pipelineCount = std::max(scene.pipelineCount, 1u),
+			.instanced = scene.instanced,
+		};
+
+		/* Indirect buffers are rewritten in place, so no frame may still read them */
+		if (_gpuDriven)
+		{
+			waitIdle();
+		}
+
+		if (_scene.pipelineCount != previous.pipelineCount)
+		{
+			/* Pipelines may still be referenced by frames in flight */
+			waitIdle();
+			destroyGraphicsPipelines();
+			createGraphicsPipeline();
+		}
+
+		populateScene();
+		buildDrawList();
+
+		spdlog::info(std::format("loaded scene, objects={}, pipelines={}, instanced={}, draws={}", _scene.objectCount, _scene.pipelineCount, _scene.instanced, _drawList.size()));
+	}
+
+	/**
+	* replace the entities of the world with the scene's objects, laid out on a square grid
+	*/
+	void Engine::populateScene()
+	{
+		_world.clear();
+
+		uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(_scene.objectCount))));
+		for (uint32_t group = 0; group < _scene.pipelineCount; group++)
+		{
+			/* Objects are split over pipelines in contiguous groups */
+			uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(group) * _scene.objectCount / _scene.pipelineCount);
+			uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(group + 1) * _scene.objectCount / _scene.pipelineCount);
+
+			for (uint32_t object = first; object < last; object++)
+			{
+				_world.createEntity(
+					Transform{
+						.position = { static_cast<float>(object % side) * 1.5f, static_cast<float>(object / side) * 1.5f, 0.0f },
+						.scale = 1.0f,
+					},
+					Bounds{},
+					Renderable{
+						.mesh = &_mesh,
+						.pipeline = group,
+						.localRadius = 0.5f,
+					}
+				);
+			}
+		}
+
+		/* Bounds follow the transforms, every chunk is independent */
+		_world.parallelEachChunk<const Transform, const Renderable, Bounds>(_jobSystem, [](const ChunkView<const Transform, const Renderable, Bounds>& view, EntityCommandBuffer&)
+		{
+			std::span<const Transform> transforms = view.get<const Transform>();
+			std::span<const Renderable> renderables = view.get<const Renderable>();
+			std::span<Bounds> bounds = view.get<Bounds>();
+
+			for (size_t i = 0; i < view.size(); i++)
+			{
+				bounds[i] = Bounds{
+					.center = { transforms[i].position[0], transforms[i].position[1], transforms[i].position[2] },
+					.radius = renderables[i].localRadius * transforms[i].scale,
+				};
+			}
+		});
+	}
+
+	/**
+	* gather one draw candidate and its bounds per renderable of the world in chunk order
+	* without frustum culling every candidate is drawn, otherwise the draw list is rebuilt from the visible ones every frame
+	*/
+	void Engine::buildDrawList()
+	{
+		_drawCandidates.clear();
+		_boundsX.clear();
+		_boundsY.clear();
+		_boundsZ.clear();
+		_boundsRadius.clear();
+
+		_world.eachChunk<const Transform, const Renderable, const Bounds>([this](const ChunkView<const Transform, const Renderable, const Bounds>& view)
+		{
+			std::span<const Transform> transforms = view.get<const Transform>();
+			std::span<const Renderable> renderables = view.get<const Renderable>();
+			std::span<const Bounds> bounds = view.get<const Bounds>();
+
+			for (size_t i = 0; i < view.size(); i++)
+			{
+				_drawCandidates.push_back(RenderItem{
+					.pass = 0,
+					.pipeline = renderables[i].pipeline,
+					.material = renderables[i].material,
+					.mesh = _renderQueue.registerMesh(renderables[i].mesh),
+					.instance = {
+						.transform = { transforms[i].position[0], transforms[i].position[1], transforms[i].position[2], transforms[i].scale },
+					},
+				});
+
+				_boundsX.push_back(bounds[i].center[0]);
+				_boundsY.push_back(bounds[i].center[1]);
+				_boundsZ.push_back(bounds[i].center[2]);
+				_boundsRadius.push_back(bounds[i].radius);
+			}
+		});
+
+		std::vector<uint32_t> all(_drawCandidates.size());
+		std::iota(all.begin(), all.end(), 0u);
+		sortDrawList(all);
+
+		if (_gpuDriven)
+		{
+			buildIndirectScene();
+		}
+	}
+
+	/**
+	* upload every renderable as GPU object, objects sharing pipeline and mesh form one batch
+	* a batch gets a command range as large as its object count, so the cull pass can never overflow it
+	*/
+	void Engine::buildIndirectScene()
+	{
+		std::vector<GpuObject> objects;
+		std::vector<IndirectBatch> batches;
+		std::map<std::pair<VkPipeline, const Mesh*>, uint32_t> batchIndices;
+
+		_world.eachChunk<const Transform, const Renderable, const Bounds>([&](const ChunkView<const Transform, const Renderable, const Bounds>& view)
+		{
+			std::span<const Transform> transforms = view.get<const Transform>();
+			std::span<const Renderable> renderables = view.get<const Renderable>();
+			std::span<const Bounds> bounds = view.get<const Bounds>();
+
+			for (size_t i = 0; i < view.size(); i++)
+			{
+				VkPipeline pipeline = renderables[i].pipeline == 0 ? _pipeline : _pipelineVariants[renderables[i].pipeline - 1];
+				const Mesh* mesh = renderables[i].mesh;
+
+				auto [it, inserted] = batchIndices.try_emplace({ pipeline, mesh }, static_cast<uint32_t>(batches.size()));
+				if (inserted)
+				{
+					batches.push_back(IndirectBatch{
+						.pipeline = pipeline,
+						.mesh = mesh,
+					});
+				}
+				batches[it->second].capacity++;
+
+				objects.push_back(GpuObject{
+					.sphere = { bounds[i].center[0], bounds[i].center[1], bounds[i].center[2], bounds[i].radius },
+					.transform = { transforms[i].position[0], transforms[i].position[1], transforms[i].position[2], transforms[i].scale },
+					.indexCount = mesh->indexCount,
+					.firstIndex = 0,
+					.vertexOffset = 0,
+					.batch = it->second,
+				});
+			}
+		});
+
+		uint32_t commandOffset = 0;
+		for (IndirectBatch& batch : batches)
+		{
+			batch.commandOffset = commandOffset;
+			commandOffset += batch.capacity;
+		}
+
+		_indirectRenderer.upload(objects, batches);
+	}
+
+	/**
+	* queue visible candidates with their view depth and build the draw list in sort key order
+	* instanced scenes merge consecutive draws sharing pipeline, material and mesh into one instanced draw
+	*/
+	void Engine::sortDrawList(std::span<const uint32_t> visible)
+	{
+		CpuScope scope("sort draws");
+
+		_renderQueue.clear();
+		_renderQueue.setInstancing(_scene.instanced);
+
+		/* Depth of the bounds center after projection, matrices are column major */
+		const float* matrix = _viewProjection;
+		for (uint32_t index : visible)
+		{
+			float x = _boundsX[index];
+			float y = _boundsY[index];
+			float z = _boundsZ[index];
+			float clipZ = matrix[2] * x + matrix[6] * y + matrix[10] * z + matrix[14];
+			float clipW = matrix[3] * x + matrix[7] * y + matrix[11] * z + matrix[15];
+
+			RenderItem item = _drawCandidates[index];
+			item.depth = clipW > 0.0f ? clipZ / clipW : 0.0f;
+			_renderQueue.submit(item);
+		}
+
+		_renderQueue.sort();
+		_renderQueue.buildDrawList(_drawList);
+	}
+
+	/**
+	* cull the draw candidates against the camera frustum and rebuild the draw list from the visible ones
+	*/
+	void Engine::cullScene()
+	{
+		SphereBounds bounds{
+			.centerX = _boundsX.data(),
+			.centerY = _boundsY.data(),
+			.centerZ = _boundsZ.data(),
+			.radius = _boundsRadius.data(),
+			.count = _drawCandidates.size(),
+		};
+
+		sortDrawList(_culler.cull(Frustum::fromViewProjection(_viewProjection), bounds));
+	}
+
+	/**
+	* create compute pipeline, the returned reference stays valid and follows shader reloads
+	*/
+	const ComputePipeline& Engine::createComputePipeline(const std::string_view& shaderPath, const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges)
+	{
+		ComputePipeline computePipeline;
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+			.pSetLayouts = setLayouts.data(),
+			.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size()),
+			.pPushConstantRanges = pushConstantRanges.data(),
+		};
+
+		if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &computePipeline.layout) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create compute pipeline layout"));
+		}
+
+		try
+		{
+			computePipeline.pipeline = buildComputePipeline(shaderPath, computePipeline.layout);
+		}
+		catch (const std::exception&)
+		{
+			vkDestroyPipelineLayout(_device, computePipeline.layout, nullptr);
+			throw;
+		}
+
+		_computePipelines.push_back(computePipeline);
+		_computePipelineShaders.push_back(std::string(shaderPath));
+
+		return _computePipelines.back();
+	}
+
+	/**
+	* create compute pipeline object for a layout
+	*/
+	VkPipeline Engine::buildComputePipeline(const std::string_view& shaderPath, VkPipelineLayout layout)
+	{
+		VkShaderModule shaderModule = loadShaderModule(shaderPath);
+
+		VkComputePipelineCreateInfo pipelineInfo{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+				.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+				.module = shaderModule,
+				.pName = "main",
+			},
+			.layout = layout,
+			.basePipelineHandle = VK_NULL_HANDLE,
+			.basePipelineIndex = -1,
+		};
+
+		VkPipeline pipeline;
+		VkResult result = vkCreateComputePipelines(_device, _pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+		vkDestroyShaderModule(_device, shaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create compute pipeline, shader={}", shaderPath.data()));
+		}
+
+		return pipeline;
+	}
+
+	/**
+	*	create vkFrameBuffer, dynamic rendering renders to the image views directly
 	*/
 	void Engine::createFrameBuffer()
 	{
+		if (_dynamicRendering)
+		{
+			return;
+		}
+
 		_swapChainFrameBuffers.resize(_swapChainImageViews.size());
 
 		for (size_t i = 0; const VkImageView & imageView : _swapChainImageViews)
@@ -541,10 +1398,390 @@ namespace engine
 				.layers = 1,
 			};
 
-			if (vkCreateFramebuffer(_device, &createInfo, nullptr, _swapChainFrameBuffers.data()) != VK_SUCCESS)
+			if (vkCreateFramebuffer(_device, &createInfo, nullptr, &_swapChainFrameBuffers[i]) != VK_SUCCESS)
 			{
 				throw std::runtime_error(std::format("failed to create framebuffer"));
 			}
+
+			i++;
+		}
+	}
+
+	/**
+	* create per frame-in-flight command pools, command buffers and synchronization objects
+	*/
+	void Engine::createFrameResources()
+	{
+		QueueFamilyIndicies indicies = findQueueFamilyIndices(_physicalDevice);
+
+		_frames.resize(_framesInFlight);
+		_imagesInFlight.assign(_swapChainImages.size(), VK_NULL_HANDLE);
+		_currentFrame = 0;
+
+		for (FrameData& frame : _frames)
+		{
+			VkCommandPoolCreateInfo poolInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = indicies.graphicsFamily.value(),
+			};
+
+			if (vkCreateCommandPool(_device, &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create command pool"));
+			}
+
+			VkCommandBufferAllocateInfo allocInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = frame.commandPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &frame.commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to allocate command buffer"));
+			}
+
+			VkSemaphoreCreateInfo semaphoreInfo{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			};
+
+			/* Fences start signaled so the first wait on each frame returns immediately */
+			VkFenceCreateInfo fenceInfo{
+				.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+				.flags = VK_FENCE_CREATE_SIGNALED_BIT,
+			};
+
+			if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore) != VK_SUCCESS
+				|| vkCreateFence(_device, &fenceInfo, nullptr, &frame.inFlightFence) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create frame synchronization objects"));
+			}
+		}
+
+		createRenderFinishedSemaphores();
+
+		_recorder.init(_device, indicies.graphicsFamily.value(), _framesInFlight, _jobSystem);
+
+		spdlog::debug(std::format("created frame resources, framesInFlight={}", _framesInFlight));
+	}
+
+	/**
+	* create one render finished semaphore per swap chain image
+	*/
+	void Engine::createRenderFinishedSemaphores()
+	{
+		VkSemaphoreCreateInfo semaphoreInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		};
+
+		_renderFinishedSemaphores.resize(_swapChainImages.size());
+		for (VkSemaphore& semaphore : _renderFinishedSemaphores)
+		{
+			if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create render finished semaphore"));
+			}
+		}
+	}
+
+	/**
+	* measure secondary command buffer recording time of a synthetic draw list for growing thread counts
+	*/
+	void Engine::benchmarkRecording()
+	{
+		if (_recordBenchmarkDraws == 0)
+		{
+			return;
+		}
+
+		constexpr uint32_t iterations = 32;
+
+		std::vector<DrawCommand> draws(_recordBenchmarkDraws, DrawCommand{
+			.mesh = &_mesh,
+			.instanceCount = 1,
+		});
+
+		RecordContext context{
+			.renderPass = _renderPass,
+			.subpass = 0,
+			.framebuffer = _dynamicRendering ? VK_NULL_HANDLE : _swapChainFrameBuffers[0],
+			.colorFormat = _swapChainImageFormat,
+			.pipeline = _pipeline,
+			.viewport = { 0.0f, 0.0f, static_cast<float>(_swapChainExtent.width), static_cast<float>(_swapChainExtent.height), 0.0f, 1.0f },
+			.scissor = { { 0, 0 }, _swapChainExtent },
+			.vertexBufferCount = _vertexFormat.getBindingCount(),
+			.pipelineLayout = _pipelineLayout,
+			.descriptorSet = _bindlessHeap.getDescriptorSet(),
+			.viewProjection = _viewProjection,
+			.instanceBuffer = _frameAllocatorIndices[0],
+		};
+
+		uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<uint32_t> threadCounts;
+		for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+
+		double baseline = 0.0;
+		for (uint32_t threads : threadCounts)
+		{
+			JobSystem jobSystem;
+			jobSystem.init(threads);
+
+			ParallelRecorder recorder;
+			recorder.init(_device, _queueFamilyIndicies.graphicsFamily.value(), 1, jobSystem);
+
+			/* Warm up pools so their first growth is not measured */
+			recorder.beginFrame(0);
+			recorder.record(0, context, draws);
+
+			std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				/* Nothing is submitted, every iteration can reuse the slot */
+				recorder.beginFrame(0);
+				recorder.record(0, context, draws);
+			}
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+
+			recorder.destroy();
+			jobSystem.destroy();
+
+			double average = elapsed.count() / iterations;
+			baseline = threads == 1 ? average : baseline;
+
+			spdlog::info(std::format("record benchmark, draws={}, threads={}, time={:.3f}ms, speedup={:.2f}x", draws.size(), threads, average, baseline / average));
+		}
+	}
+
+	/**
+	* render and present a single frame, returns false when no frame was presented
+	*/
+	bool Engine::drawFrame()
+	{
+		if (_profiler != nullptr)
+		{
+			_profiler->beginFrame();
+		}
+		CpuScope frameScope("frame");
+
+		if (_shaderLibrary.isHotReloadEnabled())
+		{
+			reloadShaders();
+		}
+
+		if (_framebufferResized && !recreateSwapChain())
+		{
+			return false;
+		}
+
+		/* Culling only touches CPU data, so it overlaps with the GPU still working on this frame slot */
+		if (_frustumCulling && !_gpuDriven)
+		{
+			CpuScope scope("cull");
+			cullScene();
+		}
+
+		FrameData& frame = _frames[_currentFrame];
+
+		/* Acquire wait covers the frame slot fence and the swap chain image, everything blocking before recording */
+		std::chrono::steady_clock::time_point acquireBegin = std::chrono::steady_clock::now();
+
+		/* Only wait for the GPU to finish the frame that last used this slot */
+		{
+			CpuScope scope("wait for frame");
+			vkWaitForFences(_device, 1, &frame.inFlightFence, VK_TRUE, UINT64_MAX);
+		}
+
+		/* Descriptors released and per draw data written while this slot was last recorded are no longer read */
+		_bindlessHeap.beginFrame(_currentFrame);
+		_frameAllocator.beginFrame(_currentFrame);
+		_recorder.beginFrame(_currentFrame);
+		if (_dynamicRendering)
+		{
+			_renderGraph.beginFrame(_currentFrame);
+		}
+
+		uint32_t imageIndex;
+		VkResult result;
+		{
+			CpuScope scope("acquire image");
+			result = vkAcquireNextImageKHR(_device, _swapchain, UINT64_MAX, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &imageIndex);
+		}
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			/* Fence is still signaled since nothing was submitted, so the slot is reusable */
+			recreateSwapChain();
+			return false;
+		}
+		else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+		{
+			throw std::runtime_error(std::format("failed to acquire swap chain image"));
+		}
+
+		/* The swap chain may hand out an image that is still used by another frame slot */
+		if (_imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+		{
+			vkWaitForFences(_device, 1, &_imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+		}
+		_imagesInFlight[imageIndex] = frame.inFlightFence;
+
+		_frameTiming.acquire = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - acquireBegin).count();
+
+		vkResetFences(_device, 1, &frame.inFlightFence);
+
+		/* Uploads issued since the last frame are submitted and become visible to this frame */
+		UploadTicket uploads = _uploadQueue.flush();
+
+		{
+			CpuScope scope("record");
+			vkResetCommandPool(_device, frame.commandPool, 0);
+			recordCommandBuffer(frame.commandBuffer, imageIndex);
+		}
+
+		VkSemaphore waitSemaphores[3] = { frame.imageAvailableSemaphore };
+		VkPipelineStageFlags waitStages[3] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		uint64_t waitValues[3] = { 0 };
+		uint32_t waitCount = 1;
+
+		/* Only wait on a timeline when new work was submitted on it since the previous frame */
+		if (uploads.value > _uploadWaitValue)
+		{
+			waitSemaphores[waitCount] = _uploadQueue.getTimelineSemaphore();
+			waitStages[waitCount] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			waitValues[waitCount] = uploads.value;
+			waitCount++;
+			_uploadWaitValue = uploads.value;
+		}
+
+		uint64_t compute = _computeQueue.getSubmittedValue();
+		if (compute > _computeWaitValue)
+		{
+			waitSemaphores[waitCount] = _computeQueue.getTimelineSemaphore();
+			waitStages[waitCount] = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			waitValues[waitCount] = compute;
+			waitCount++;
+			_computeWaitValue = compute;
+		}
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.waitSemaphoreValueCount = waitCount,
+			.pWaitSemaphoreValues = waitValues,
+		};
+
+		VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timelineInfo,
+			.waitSemaphoreCount = waitCount,
+			.pWaitSemaphores = waitSemaphores,
+			.pWaitDstStageMask = waitStages,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &frame.commandBuffer,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &_renderFinishedSemaphores[imageIndex],
+		};
+
+		{
+			CpuScope scope("submit");
+			if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, frame.inFlightFence) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to submit draw command buffer"));
+			}
+		}
+
+		VkPresentInfoKHR presentInfo{
+			.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			.waitSemaphoreCount = 1,
+			.pWaitSemaphores = &_renderFinishedSemaphores[imageIndex],
+			.swapchainCount = 1,
+			.pSwapchains = &_swapchain,
+			.pImageIndices = &imageIndex,
+		};
+
+		std::chrono::steady_clock::time_point presentBegin = std::chrono::steady_clock::now();
+		{
+			CpuScope scope("present");
+			result = vkQueuePresentKHR(_presentQueue, &presentInfo);
+		}
+		_frameTiming.present = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - presentBegin).count();
+
+		/* Timestamps are read back when the slot is reused, so this is the GPU time of a frame framesInFlight ago */
+		_frameTiming.gpu = _graphicsProfiler.getFrameTime();
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+		{
+			_framebufferResized = true;
+		}
+		else if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to present swap chain image"));
+		}
+
+		if (!_firstFramePresented)
+		{
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _startupBegin;
+			spdlog::info(std::format("time to first frame {:.3f}ms", elapsed.count()));
+			_firstFramePresented = true;
+		}
+
+		_currentFrame = (_currentFrame + 1) % _framesInFlight;
+
+		return true;
+	}
+
+	/**
+	* recreate swap chain and its extent dependent objects, returns false while the window has no drawable area
+	*/
+	bool Engine::recreateSwapChain()
+	{
+		VkExtent2D drawableExtent = getDrawableExtent();
+
+		if (drawableExtent.width == 0 || drawableExtent.height == 0)
+		{
+			return false;
+		}
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+		/* Only the frames still referencing retired images have to finish, not the whole device */
+		std::vector<VkFence> inFlightFences;
+		for (const FrameData& frame : _frames)
+		{
+			inFlightFences.push_back(frame.inFlightFence);
+		}
+		vkWaitForFences(_device, static_cast<uint32_t>(inFlightFences.size()), inFlightFences.data(), VK_TRUE, UINT64_MAX);
+
+		/* Pending presents may still wait on the render finished semaphores that are about to be destroyed */
+		vkQueueWaitIdle(_presentQueue);
+
+		/* Pipelines and the render pass are kept, viewport and scissor are dynamic states, dynamic rendering leaves no framebuffers to rebuild */
+		destroySwapChainResources();
+		createSwapChain();
+		createImageview();
+		createFrameBuffer();
+		createRenderFinishedSemaphores();
+
+		_imagesInFlight.assign(_swapChainImages.size(), VK_NULL_HANDLE);
+		_framebufferResized = false;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+		spdlog::debug(std::format("recreated swap chain in {:.3f}ms, extent={}x{}", elapsed.count(), _swapChainExtent.width, _swapChainExtent.height));
+
+		return true;
+	}
+
+	/**
+	* wait until the device finished all submitted work
+	*/
+	void Engine::waitIdle()
+	{
+		if (_device != VK_NULL_HANDLE)
+		{
+			vkDeviceWaitIdle(_device);
 		}
 	}
 
@@ -635,6 +1872,17 @@ namespace engine
 	*/
 	std::vector<const char*> Engine::getRequiredExtensions()
 	{
+		if (_headless)
+		{
+			std::vector<const char*> extensions = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+			if (_enableValidationLayers)
+			{
+				extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			}
+
+			return extensions;
+		}
+
 		uint32_t sdlExtensionCount = 0;
 		if (SDL_Vulkan_GetInstanceExtensions(&sdlExtensionCount, nullptr) != SDL_TRUE)
 		{
@@ -669,10 +1917,19 @@ namespace engine
 
 		for (const VkPhysicalDevice& device : devices)
 		{
+			/* Devices missing a feature createLogicalDevice always enables would fail vkCreateDevice, never pick them */
+			if (!isDeviceSuitable(device))
+			{
+				VkPhysicalDeviceProperties properties;
+				vkGetPhysicalDeviceProperties(device, &properties);
+				spdlog::debug(std::format("Physical device unsuitable: name={}", properties.deviceName));
+				continue;
+			}
+
 			candidates.insert(std::make_pair(calculatePhysicalDeviceScore(device), device));
 		}
 
-		if (candidates.rbegin()->first > 0)
+		if (!candidates.empty() && candidates.rbegin()->first > 0)
 		{
 			return candidates.rbegin()->second;
 		}
@@ -698,28 +1955,83 @@ namespace engine
 		score += deviceProperties.limits.maxImageDimension2D;
 		score = !deviceFeatures.geometryShader ? 0 : score;
 
-		spdlog::debug(std::format("Physical device Info: name={}, score={}", deviceProperties.deviceName, score));
+		spdlog::debug(std::format("Physical device Info: name={}, score={}", deviceProperties.deviceName, score));
+
+		return score;
+	}
+
+	/**
+	* check if physical device is suitable
+	*/
+	bool Engine::isDeviceSuitable(const VkPhysicalDevice& device)
+	{
+		QueueFamilyIndicies indices = findQueueFamilyIndices(device);
+
+		bool extensionSupported = checkDeviceExtensionSupport(device);
+
+		bool swapChainAdequate = false;
+		if (extensionSupported)
+		{
+			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+		}
+
+		return indices.isComplete() && extensionSupported && swapChainAdequate && checkVulkan12FeatureSupport(device);
+	}
+
+	/**
+	* check physical device supports the descriptor indexing features the bindless heap needs and timeline semaphores
+	*/
+	bool Engine::checkVulkan12FeatureSupport(const VkPhysicalDevice& device)
+	{
+		VkPhysicalDeviceVulkan12Features vulkan12Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+		};
+
+		VkPhysicalDeviceFeatures2 features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vulkan12Features,
+		};
 
-		return score;
+		vkGetPhysicalDeviceFeatures2(device, &features);
+
+		return vulkan12Features.descriptorIndexing
+			&& vulkan12Features.shaderSampledImageArrayNonUniformIndexing
+			&& vulkan12Features.shaderStorageBufferArrayNonUniformIndexing
+			&& vulkan12Features.descriptorBindingSampledImageUpdateAfterBind
+			&& vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind
+			&& vulkan12Features.descriptorBindingUpdateUnusedWhilePending
+			&& vulkan12Features.descriptorBindingPartiallyBound
+			&& vulkan12Features.runtimeDescriptorArray
+			&& vulkan12Features.timelineSemaphore;
 	}
 
 	/**
-	* check if physical device is suitable
+	* check physical device is a Vulkan 1.3 device with dynamic rendering and synchronization2
 	*/
-	bool Engine::isDeviceSuitable(const VkPhysicalDevice& device)
+	bool Engine::checkDynamicRenderingSupport(const VkPhysicalDevice& device)
 	{
-		QueueFamilyIndicies indices = findQueueFamilyIndices(device);
-
-		bool extensionSupported = checkDeviceExtensionSupport(device);
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(device, &properties);
 
-		bool swapChainAdequate = false;
-		if (extensionSupported)
+		/* The 1.3 feature struct can only be queried from a 1.3 device */
+		if (properties.apiVersion < VK_API_VERSION_1_3)
 		{
-			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-			swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+			return false;
 		}
 
-		return indices.isComplete() && extensionSupported && swapChainAdequate;
+		VkPhysicalDeviceVulkan13Features vulkan13Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+		};
+
+		VkPhysicalDeviceFeatures2 features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vulkan13Features,
+		};
+
+		vkGetPhysicalDeviceFeatures2(device, &features);
+
+		return vulkan13Features.dynamicRendering && vulkan13Features.synchronization2;
 	}
 
 	/**
@@ -758,7 +2070,7 @@ namespace engine
 		int i = 0;
 		for (const VkQueueFamilyProperties& queueFamily : queueFamilies)
 		{
-			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+			if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indicies.graphicsFamily.has_value())
 			{
 				indicies.graphicsFamily = i;
 			}
@@ -766,13 +2078,24 @@ namespace engine
 			VkBool32 presentSupport = false;
 			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
 
-			if (presentSupport)
+			if (presentSupport && !indicies.presentFamily.has_value())
 			{
 				indicies.presentFamily = i;
 			}
 
-			if (indicies.isComplete()) {
-				break;
+			if ((queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indicies.computeFamily.has_value())
+			{
+				indicies.computeFamily = i;
+			}
+
+			/* Prefer a transfer-only family (DMA engine), then any non-graphics family with transfer support */
+			if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				bool transferOnly = !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT);
+				if (!indicies.transferFamily.has_value() || transferOnly)
+				{
+					indicies.transferFamily = i;
+				}
 			}
 
 			i++;
@@ -854,13 +2177,8 @@ namespace engine
 		}
 		else
 		{
-			int width, height;
-			SDL_Vulkan_GetDrawableSize(_window, &width, &height);
-
-			VkExtent2D actualExtent = {
-				static_cast<uint32_t>(width),
-				static_cast<uint32_t>(height)
-			};
+			/* Headless surfaces leave the extent to the application, like some window systems */
+			VkExtent2D actualExtent = getDrawableExtent();
 
 			actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
 			actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
@@ -869,15 +2187,361 @@ namespace engine
 		}
 	}
 
+	/**
+	* size of the window's drawable area, the configured extent in headless mode
+	*/
+	VkExtent2D Engine::getDrawableExtent() const
+	{
+		if (_headless)
+		{
+			return _headlessExtent;
+		}
+
+		int width = 0;
+		int height = 0;
+		SDL_Vulkan_GetDrawableSize(_window, &width, &height);
+
+		return VkExtent2D{
+			.width = static_cast<uint32_t>(width),
+			.height = static_cast<uint32_t>(height),
+		};
+	}
+
+	/**
+	* check pipeline cache header matches the selected physical device
+	*/
+	bool Engine::isPipelineCacheCompatible(const std::vector<char>& data)
+	{
+		/* VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID */
+		constexpr size_t headerSize = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+		if (data.size() < headerSize)
+		{
+			return false;
+		}
+
+		uint32_t header[4];
+		std::memcpy(header, data.data(), sizeof(header));
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(_physicalDevice, &deviceProperties);
+
+		return header[0] >= headerSize
+			&& header[0] <= data.size()
+			&& header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+			&& header[2] == deviceProperties.vendorID
+			&& header[3] == deviceProperties.deviceID
+			&& std::memcmp(data.data() + sizeof(header), deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+
+	/**
+	* write pipeline cache back to disk
+	*/
+	void Engine::savePipelineCache()
+	{
+		if (_pipelineCache == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(_device, _pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+		{
+			spdlog::warn(std::format("failed to query pipeline cache size"));
+			return;
+		}
+
+		std::vector<char> data(dataSize);
+		if (vkGetPipelineCacheData(_device, _pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+		{
+			spdlog::warn(std::format("failed to read pipeline cache data"));
+			return;
+		}
+
+		/* Write to a temporary file first so a crash never leaves a truncated cache behind */
+		std::string temporaryPath = _pipelineCachePath + ".tmp";
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				spdlog::warn(std::format("failed to open pipeline cache file, path={}", temporaryPath));
+				return;
+			}
+
+			file.write(data.data(), static_cast<std::streamsize>(dataSize));
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, _pipelineCachePath, error);
+		if (error)
+		{
+			spdlog::warn(std::format("failed to save pipeline cache, path={}, error={}", _pipelineCachePath, error.message()));
+			return;
+		}
+
+		spdlog::debug(std::format("saved pipeline cache, path={}, size={}", _pipelineCachePath, dataSize));
+	}
+
+	/**
+	* record draw commands into command buffer
+	*/
+	void Engine::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+	{
+		VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		};
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to begin recording command buffer"));
+		}
+
+		/* Query reset has to happen outside the render pass */
+		_graphicsProfiler.beginFrame(commandBuffer, _currentFrame);
+		uint32_t frameScope = _graphicsProfiler.beginScope(commandBuffer, "frame");
+
+		_uploadQueue.recordAcquireBarriers(commandBuffer);
+
+		RecordContext context{
+			.renderPass = _renderPass,
+			.subpass = 0,
+			.framebuffer = _dynamicRendering ? VK_NULL_HANDLE : _swapChainFrameBuffers[imageIndex],
+			.colorFormat = _swapChainImageFormat,
+			.pipeline = _pipeline,
+			.viewport = {
+				.x = 0.0f,
+				.y = 0.0f,
+				.width = static_cast<float>(_swapChainExtent.width),
+				.height = static_cast<float>(_swapChainExtent.height),
+				.minDepth = 0.0f,
+				.maxDepth = 1.0f,
+			},
+			.scissor = {
+				.offset = { 0, 0 },
+				.extent = _swapChainExtent,
+			},
+			.vertexBufferCount = _vertexFormat.getBindingCount(),
+			.pipelineLayout = _pipelineLayout,
+			.descriptorSet = _bindlessHeap.getDescriptorSet(),
+			.viewProjection = _viewProjection,
+			.instanceBuffer = _frameAllocatorIndices[_currentFrame],
+			.instanceOffset = _gpuDriven ? 0 : _renderQueue.upload(_frameAllocator),
+		};
+
+		if (_dynamicRendering)
+		{
+			recordFrameGraph(commandBuffer, imageIndex, context);
+		}
+		else
+		{
+			/* Dispatches are not allowed inside a render pass, GPU driven frames cull first */
+			if (_gpuDriven)
+			{
+				GpuScope cullScope(_graphicsProfiler, commandBuffer, "cull");
+				_indirectRenderer.recordCull(commandBuffer, _currentFrame, Frustum::fromViewProjection(_viewProjection));
+				_indirectRenderer.recordDrawBarrier(commandBuffer);
+			}
+
+			recordMainPass(commandBuffer, imageIndex, context);
+		}
+
+		_graphicsProfiler.endScope(commandBuffer, frameScope);
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to record command buffer"));
+		}
+	}
+
+	/**
+	* describe the frame as a render graph, the graph places the layout transitions of the swap chain image and the cull to draw dependency
+	*/
+	void Engine::recordFrameGraph(VkCommandBuffer commandBuffer, uint32_t imageIndex, const RecordContext& context)
+	{
+		_renderGraph.reset();
+
+		/* The acquire semaphore is waited on at color output, so the first transition has to wait there too */
+		RenderResource swapChainImage = _renderGraph.importImage("swap chain", _swapChainImages[imageIndex], _swapChainImageViews[imageIndex], VK_IMAGE_ASPECT_COLOR_BIT, AccessInfo{
+			.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.access = VK_ACCESS_2_NONE,
+			.layout = VK_IMAGE_LAYOUT_UNDEFINED,
+		});
+
+		/* The cull pass writes the indirect commands and counts the main pass draws with */
+		std::vector<RenderResource> indirectBuffers;
+		if (_gpuDriven)
+		{
+			indirectBuffers.push_back(_renderGraph.importBuffer("indirect commands", _indirectRenderer.getCommandBuffer(_currentFrame)));
+			indirectBuffers.push_back(_renderGraph.importBuffer("indirect counts", _indirectRenderer.getCountBuffer(_currentFrame)));
+
+			uint32_t cullPass = _renderGraph.addPass("cull", [this](VkCommandBuffer commandBuffer, const RenderGraph&) {
+				GpuScope cullScope(_graphicsProfiler, commandBuffer, "cull");
+				_indirectRenderer.recordCull(commandBuffer, _currentFrame, Frustum::fromViewProjection(_viewProjection));
+			});
+
+			/* Counts are cleared with a transfer before the dispatch appends to them */
+			_renderGraph.write(cullPass, indirectBuffers[0], ResourceAccess::StorageWrite);
+			_renderGraph.write(cullPass, indirectBuffers[1], ResourceAccess::TransferWrite);
+			_renderGraph.write(cullPass, indirectBuffers[1], ResourceAccess::StorageWrite);
+		}
+
+		uint32_t mainPass = _renderGraph.addPass("main pass", [this, imageIndex, &context](VkCommandBuffer commandBuffer, const RenderGraph&) {
+			recordMainPass(commandBuffer, imageIndex, context);
+		});
+		_renderGraph.write(mainPass, swapChainImage, ResourceAccess::ColorAttachmentWrite);
+		for (RenderResource indirectBuffer : indirectBuffers)
+		{
+			_renderGraph.read(mainPass, indirectBuffer, ResourceAccess::IndirectRead);
+		}
+
+		_renderGraph.markOutput(swapChainImage, ResourceAccess::Present);
+		_renderGraph.compile();
+		_renderGraph.execute(commandBuffer);
+	}
+
+	/**
+	* record the scene into the swap chain image, inline, from secondaries or as indirect draws
+	*/
+	void Engine::recordMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, const RecordContext& context)
+	{
+		/* Timestamps can not be written inside a subpass recorded with secondaries, so the scope encloses the whole pass */
+		GpuScope passScope(_graphicsProfiler, commandBuffer, "main pass");
+
+		/* A handful of indirect draws covers the whole scene, there is nothing to spread over workers */
+		if (_gpuDriven)
+		{
+			beginMainPass(commandBuffer, imageIndex, false);
+			_indirectRenderer.recordDraws(commandBuffer, _currentFrame, context);
+		}
+		/* Small draw lists are cheaper to record inline than to hand out to workers */
+		else if (_recorder.shouldRecordParallel(_drawList.size()))
+		{
+			std::span<const VkCommandBuffer> secondaries = _recorder.record(_currentFrame, context, _drawList);
+
+			beginMainPass(commandBuffer, imageIndex, true);
+			vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+		}
+		else
+		{
+			beginMainPass(commandBuffer, imageIndex, false);
+			recordDraws(commandBuffer, context, _drawList);
+		}
+
+		endMainPass(commandBuffer);
+	}
+
+	/**
+	* begin rendering to a swap chain image cleared to black, with dynamic rendering the render graph has transitioned it for color output
+	*/
+	void Engine::beginMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaries)
+	{
+		VkClearValue clearColor = { {{ 0.0f, 0.0f, 0.0f, 1.0f }} };
+
+		if (!_dynamicRendering)
+		{
+			VkRenderPassBeginInfo renderPassInfo{
+				.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+				.renderPass = _renderPass,
+				.framebuffer = _swapChainFrameBuffers[imageIndex],
+				.renderArea = {
+					.offset = { 0, 0 },
+					.extent = _swapChainExtent,
+				},
+				.clearValueCount = 1,
+				.pClearValues = &clearColor,
+			};
+
+			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, secondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+			return;
+		}
+
+		VkRenderingAttachmentInfo colorAttachment{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+			.imageView = _swapChainImageViews[imageIndex],
+			.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+			.clearValue = clearColor,
+		};
+
+		VkRenderingInfo renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+			.flags = secondaries ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0u,
+			.renderArea = {
+				.offset = { 0, 0 },
+				.extent = _swapChainExtent,
+			},
+			.layerCount = 1,
+			.colorAttachmentCount = 1,
+			.pColorAttachments = &colorAttachment,
+		};
+
+		vkCmdBeginRendering(commandBuffer, &renderingInfo);
+	}
+
+	/**
+	* end rendering to a swap chain image, with dynamic rendering the render graph transitions it for presentation
+	*/
+	void Engine::endMainPass(VkCommandBuffer commandBuffer)
+	{
+		if (!_dynamicRendering)
+		{
+			vkCmdEndRenderPass(commandBuffer);
+			return;
+		}
+
+		vkCmdEndRendering(commandBuffer);
+	}
+
+	/**
+	* destroy per frame-in-flight resources
+	*/
+	void Engine::destroyFrameResources()
+	{
+		for (const FrameData& frame : _frames)
+		{
+			vkDestroyFence(_device, frame.inFlightFence, nullptr);
+			vkDestroySemaphore(_device, frame.imageAvailableSemaphore, nullptr);
+			vkDestroyCommandPool(_device, frame.commandPool, nullptr);
+		}
+		_frames.clear();
+		_imagesInFlight.clear();
+		_recorder.destroy();
+	}
+
+	/**
+	* destroy swap chain extent dependent objects
+	*/
+	void Engine::destroySwapChainResources()
+	{
+		for (const VkFramebuffer& buffer : _swapChainFrameBuffers)
+		{
+			vkDestroyFramebuffer(_device, buffer, nullptr);
+		}
+		_swapChainFrameBuffers.clear();
+
+		for (const VkImageView& imageView : _swapChainImageViews)
+		{
+			vkDestroyImageView(_device, imageView, nullptr);
+		}
+		_swapChainImageViews.clear();
+
+		for (const VkSemaphore& semaphore : _renderFinishedSemaphores)
+		{
+			vkDestroySemaphore(_device, semaphore, nullptr);
+		}
+		_renderFinishedSemaphores.clear();
+	}
+
 	/**
 	* create shader module
 	*/
-	VkShaderModule Engine::createShaderModule(const std::vector<char>& code)
+	VkShaderModule Engine::createShaderModule(std::span<const uint32_t> code)
 	{
 		VkShaderModuleCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-			.codeSize = code.size(),
-			.pCode = reinterpret_cast<const uint32_t*>(code.data()),
+			.codeSize = code.size_bytes(),
+			.pCode = code.data(),
 		};
 
 		VkShaderModule shaderModule;
@@ -890,25 +2554,163 @@ namespace engine
 	}
 
 	/**
-	* destroy Vulkan instance
+	* load shader module from the shader library, then the asset pack, then a mapped SPIR-V file
 	*/
-	void Engine::destroyInstance()
+	VkShaderModule Engine::loadShaderModule(const std::string_view& path)
 	{
-		for (const VkFramebuffer& buffer : _swapChainFrameBuffers)
+		std::optional<std::span<const uint32_t>> library = _shaderLibrary.find(path);
+		if (library.has_value())
 		{
-			vkDestroyFramebuffer(_device, buffer, nullptr);
+			return createShaderModule(library.value());
+		}
+
+		std::optional<std::span<const uint32_t>> packed = _assetPack.isOpen() ? _assetPack.findSpirv(path) : std::nullopt;
+		if (packed.has_value())
+		{
+			return createShaderModule(packed.value());
+		}
+
+		MappedFile file(path);
+		std::span<const std::byte> data = file.getData();
+		if (data.size() % sizeof(uint32_t) != 0)
+		{
+			throw std::runtime_error(std::format("invalid SPIR-V file size. filename={}", path.data()));
+		}
+
+		return createShaderModule(std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(data.data()), data.size() / sizeof(uint32_t)));
+	}
+
+	/**
+	* rebuild the pipelines using shaders that were recompiled since the last frame
+	*/
+	void Engine::reloadShaders()
+	{
+		std::vector<std::string> changed = _shaderLibrary.poll();
+		if (changed.empty())
+		{
+			return;
+		}
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+		auto isChanged = [&changed](const std::string_view name) {
+			return std::find(changed.begin(), changed.end(), name) != changed.end();
+		};
+
+		/* Pipelines may still be referenced by frames in flight */
+		waitIdle();
+
+		uint32_t rebuilt = 0;
+		if (isChanged("shader/vertex.spv") || isChanged("shader/vertex_indirect.spv") || isChanged("shader/fragment.spv"))
+		{
+			destroyGraphicsPipelines();
+			createGraphicsPipeline();
+			buildDrawList();
+			rebuilt++;
+		}
+
+		for (size_t i = 0; i < _computePipelines.size(); i++)
+		{
+			if (isChanged(_computePipelineShaders[i]))
+			{
+				vkDestroyPipeline(_device, _computePipelines[i].pipeline, nullptr);
+				_computePipelines[i].pipeline = buildComputePipeline(_computePipelineShaders[i], _computePipelines[i].layout);
+				rebuilt++;
+			}
 		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - begin;
+		spdlog::info(std::format("reloaded {} shaders, rebuilt {} pipelines in {:.3f}ms", changed.size(), rebuilt, elapsed.count()));
+	}
+
+	/**
+	* destroy graphics pipeline, its variants and layout
+	*/
+	void Engine::destroyGraphicsPipelines()
+	{
 		vkDestroyPipeline(_device, _pipeline, nullptr);
+		for (VkPipeline pipeline : _pipelineVariants)
+		{
+			vkDestroyPipeline(_device, pipeline, nullptr);
+		}
+		_pipelineVariants.clear();
+
 		vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
-		vkDestroyRenderPass(_device, _renderPass, nullptr);
-		for (const VkImageView& imageView : _swapChainImageViews)
+		_pipeline = VK_NULL_HANDLE;
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+
+	/**
+	* destroy Vulkan instance
+	*/
+	void Engine::destroyInstance()
+	{
+		waitIdle();
+		exportProfile();
+		_graphicsProfiler.destroy();
+		_computeProfiler.destroy();
+		destroyFrameResources();
+		destroySwapChainResources();
+		_drawList.clear();
+		_world.clear();
+		_indirectRenderer.destroy();
+		_renderQueue.destroy();
+		for (uint32_t index : _frameAllocatorIndices)
 		{
-			vkDestroyImageView(_device, imageView, nullptr);
+			_bindlessHeap.release(BindlessType::Buffer, index);
 		}
+		_frameAllocatorIndices.clear();
+		_frameAllocator.destroy(_memoryAllocator);
+		_renderGraph.destroy();
+		_bindlessHeap.destroy();
+		destroyMesh(_memoryAllocator, _mesh);
+		destroyGraphicsPipelines();
+		for (const ComputePipeline& computePipeline : _computePipelines)
+		{
+			vkDestroyPipeline(_device, computePipeline.pipeline, nullptr);
+			vkDestroyPipelineLayout(_device, computePipeline.layout, nullptr);
+		}
+		_computePipelines.clear();
+		_computePipelineShaders.clear();
+		savePipelineCache();
+		vkDestroyPipelineCache(_device, _pipelineCache, nullptr);
+		vkDestroyRenderPass(_device, _renderPass, nullptr);
 		vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+		_computeQueue.destroy();
+		_uploadQueue.destroy();
+		_memoryAllocator.logStats();
+		_memoryAllocator.destroy();
 		vkDestroyDevice(_device, nullptr);
 		vkDestroySurfaceKHR(_instance, _surface, nullptr);
 		destroyDebugUtilsmessengerEXT(_instance, _debugMessaenger, nullptr);
 		vkDestroyInstance(_instance, nullptr);
+		_jobSystem.destroy();
+	}
+
+	/**
+	* write the last profiled frames as Chrome trace, the device has to be idle
+	*/
+	void Engine::exportProfile()
+	{
+		if (_profiler == nullptr || _profileTracePath.empty())
+		{
+			return;
+		}
+
+		_graphicsProfiler.collect();
+		_computeProfiler.collect();
+
+		uint64_t lastFrame = _profiler->getFrame();
+		uint64_t firstFrame = lastFrame > _profileFrames ? lastFrame - _profileFrames + 1 : 1;
+
+		try
+		{
+			_profiler->exportChromeTrace(_profileTracePath, firstFrame, lastFrame);
+		}
+		catch (const std::exception& e)
+		{
+			/* Shutdown continues, a missing trace is not worth leaking the device */
+			spdlog::error(std::format("{}", e.what()));
+		}
 	}
 }
\ No newline at end of file
@@ -2,15 +2,39 @@
 #define _ENGINE_INITIALIZER_HEADER_
 
 #include <vector>
+#include <deque>
+#include <string>
 #include <optional>
 #include <format>
+#include <chrono>
 #include <fstream>
+#include <algorithm>
 
 #include <vulkan/vulkan.h>
 #include <SDL3/SDL.h>
 #include <spdlog/spdlog.h>
-
-#include "../Prototype/Singleton.hpp"
+#include <INIReader.h>
+
+#include "../Prototype/ServiceRegistry.hpp"
+#include "../Memory/MemoryAllocator.h"
+#include "../Upload/UploadQueue.h"
+#include "../Compute/ComputeQueue.h"
+#include "../Geometry/Mesh.h"
+#include "../Asset/AssetPack.h"
+#include "../Asset/MappedFile.h"
+#include "../Shader/ShaderLibrary.h"
+#include "../Render/ParallelRecorder.h"
+#include "../Render/FrustumCulling.h"
+#include "../Render/IndirectRenderer.h"
+#include "../Render/RenderQueue.h"
+#include "../Render/BindlessHeap.h"
+#include "../Render/RenderGraph.h"
+#include "../Job/JobSystem.h"
+#include "../Profile/Profiler.h"
+#include "../Profile/GpuProfiler.h"
+#include "../Profile/FrameStats.h"
+#include "../Scene/World.h"
+#include "../Scene/Components.h"
 
 namespace engine
 {
@@ -21,6 +45,8 @@ namespace engine
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		std::optional<uint32_t> transferFamily;
+		std::optional<uint32_t> computeFamily;
 
 		constexpr const bool isComplete() const
 		{
@@ -38,32 +64,122 @@ namespace engine
 		std::vector<VkPresentModeKHR> presentModes;
 	};
 
-	class Engine : public Singleton<Engine>
+	/**
+	* Per frame-in-flight resources
+	*/
+	struct FrameData
+	{
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkSemaphore imageAvailableSemaphore = VK_NULL_HANDLE;
+		VkFence inFlightFence = VK_NULL_HANDLE;
+	};
+
+	/**
+	* Scripted scene, objects are spread over pipelines in contiguous groups
+	* instanced scenes draw every group with a single instanced draw
+	*/
+	struct DrawScene
+	{
+		uint32_t objectCount = 1;
+		uint32_t pipelineCount = 1;
+		bool instanced = false;
+	};
+
+	class Engine : public Service<Engine>
 	{
 	public:
 		Engine();
 		~Engine();
 
+		void configure(const INIReader& reader);
 		void setSDLWindow(SDL_Window* window) { _window = window; };
-
+		void setSDLSubsystems(const Uint32 subsystems) { _sdlSubsystems = subsystems; }
+		void setFramebufferResized() { _framebufferResized = true; }
+		void setAssetPackPath(const std::string_view path) { _assetPackPath = path; }
+		void setShaderHotReload(const bool hotReload) { _shaderHotReload = hotReload; }
+		void setShaderSourceDirectory(const std::string_view directory) { _shaderSourceDirectory = directory; }
+		void setShaderCompiler(const std::string_view compiler) { _shaderCompiler = compiler; }
+		void setVertexLayout(const VertexLayout layout) { _vertexLayout = layout; }
+		void setStagingBufferSize(const VkDeviceSize stagingSize) { _stagingBufferSize = stagingSize; }
+		void setMemoryBlockSize(const VkDeviceSize blockSize) { _memoryBlockSize = blockSize; }
+		void setFrameAllocatorSize(const VkDeviceSize frameSize) { _frameAllocatorSize = frameSize; }
+		void setPipelineCachePath(const std::string_view path) { _pipelineCachePath = path; }
+		void setJobThreads(const int jobThreads) { _jobThreads = jobThreads <= 0 ? 0 : static_cast<uint32_t>(jobThreads); }
+		void setRecordBenchmarkDraws(const int drawCount) { _recordBenchmarkDraws = drawCount <= 0 ? 0 : static_cast<uint32_t>(drawCount); }
+		void setProfilerEnabled(const bool enabled) { _profilerEnabled = enabled; }
+		void setProfileTracePath(const std::string_view path) { _profileTracePath = path; }
+		void setProfileFrames(const int frameCount) { _profileFrames = frameCount <= 0 ? 1 : static_cast<uint32_t>(frameCount); }
+		void setHeadless(const bool headless) { _headless = headless; }
+		void setHeadlessExtent(const int width, const int height) { _headlessExtent = { static_cast<uint32_t>(std::max(width, 1)), static_cast<uint32_t>(std::max(height, 1)) }; }
+		void setFramesInFlight(const int framesInFlight) { _framesInFlight = framesInFlight <= 0 ? 1 : static_cast<uint32_t>(framesInFlight); }
+		void setFrustumCulling(const bool culling) { _frustumCulling = culling; }
+		void setCullKernel(const CullKernel kernel) { _cullKernel = kernel; }
+		void setGpuDriven(const bool gpuDriven) { _gpuDriven = gpuDriven; }
+		void setDynamicRendering(const bool dynamicRendering) { _dynamicRendering = dynamicRendering; }
+		void setViewProjection(const float (&matrix)[16]) { std::copy(std::begin(matrix), std::end(matrix), std::begin(_viewProjection)); }
+
+		void createJobSystem();
+		void createProfiler();
+		void initSDL();
+		void initSDLSubsystems();
+		void loadPipelineCacheData();
+		void openAssetPack();
+		void createShaderLibrary();
 		void createInstance();
 		void setupDebugMessenger();
 		void searchExtensions();
 		void createSurface();
 		void selectPhysicalDevice();
 		void createLogicalDevice();
+		void createMemoryAllocator();
+		void createUploadQueue();
+		void createComputeQueue();
+		void createGpuProfilers();
+		void createPipelineCache();
 		void createSwapChain();
 		void createImageview();
 		void createRenderPass();
+		void createBindlessHeap();
+		void createFrameAllocator();
+		void createRenderGraph();
+		void createRenderQueue();
+		void createIndirectRenderer();
 		void createGraphicsPipeline();
 		void createFrameBuffer();
+		void createGeometry();
+		const ComputePipeline& createComputePipeline(const std::string_view& shaderPath, const std::vector<VkDescriptorSetLayout>& setLayouts = {}, const std::vector<VkPushConstantRange>& pushConstantRanges = {});
+		void createFrameResources();
+		void benchmarkRecording();
+		void loadScene(const DrawScene& scene);
+
+		bool drawFrame();
+		bool recreateSwapChain();
+		void waitIdle();
 
 		void destroyInstance();
 
+		static Uint32 parseSDLSubsystems(const std::string_view subsystems);
+		static VkDeviceSize parseMegabytes(long megabytes);
+
 		constexpr const VkInstance getVkInstance() const { return _instance; }
 		constexpr const VkSurfaceKHR getVkSurface() const { return _surface; }
+		constexpr const VkPhysicalDevice getVkPhysicalDevice() const { return _physicalDevice; }
 
 		constexpr const SDL_Window* getSDLWindow() const { return _window; }
+		constexpr const bool isHeadless() const { return _headless; }
+		constexpr const uint32_t getFramesInFlight() const { return _framesInFlight; }
+		constexpr const bool isGpuDriven() const { return _gpuDriven; }
+		constexpr const bool isDynamicRendering() const { return _dynamicRendering; }
+		constexpr const FrameTiming& getFrameTiming() const { return _frameTiming; }
+		constexpr const size_t getDrawCount() const { return _gpuDriven ? _indirectRenderer.getBatchCount() : _drawList.size(); }
+		constexpr const size_t getObjectCount() const { return _drawCandidates.size(); }
+		MemoryAllocator& getMemoryAllocator() { return _memoryAllocator; }
+		UploadQueue& getUploadQueue() { return _uploadQueue; }
+		ComputeQueue& getComputeQueue() { return _computeQueue; }
+		JobSystem& getJobSystem() { return _jobSystem; }
+		GpuProfiler& getGraphicsProfiler() { return _graphicsProfiler; }
+		GpuProfiler& getComputeProfiler() { return _computeProfiler; }
 
 	protected:
 
@@ -74,18 +190,108 @@ namespace engine
 		VkDevice _device = VK_NULL_HANDLE;
 		VkQueue _graphicsQueue = VK_NULL_HANDLE;
 		VkQueue _presentQueue = VK_NULL_HANDLE;
+		VkQueue _transferQueue = VK_NULL_HANDLE;
+		VkQueue _computeQueueHandle = VK_NULL_HANDLE;
+		QueueFamilyIndicies _queueFamilyIndicies;
 		VkSurfaceKHR _surface = VK_NULL_HANDLE;
+		MemoryAllocator _memoryAllocator;
+		VkDeviceSize _memoryBlockSize = 64 * 1024 * 1024;
+		UploadQueue _uploadQueue;
+		VkDeviceSize _stagingBufferSize = 32 * 1024 * 1024;
+		uint64_t _uploadWaitValue = 0;
+		ComputeQueue _computeQueue;
+		uint64_t _computeWaitValue = 0;
+		std::deque<ComputePipeline> _computePipelines;
+		std::vector<std::string> _computePipelineShaders;
 		VkSwapchainKHR _swapchain = VK_NULL_HANDLE;
 		std::vector<VkImage> _swapChainImages;
 		std::vector<VkImageView> _swapChainImageViews;
 		VkFormat _swapChainImageFormat;
 		VkExtent2D _swapChainExtent;
+		bool _framebufferResized = false;
 		VkRenderPass _renderPass = VK_NULL_HANDLE;
+
+		/* Rendering begins on the swap chain image view directly, render pass and framebuffers stay null */
+		bool _dynamicRendering = true;
+
+		/* Frames are described as passes and their resources, only with synchronization2 */
+		RenderGraph _renderGraph;
 		VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
 		VkPipeline _pipeline = VK_NULL_HANDLE;
+		std::vector<VkPipeline> _pipelineVariants;
+		DrawScene _scene;
+		VertexLayout _vertexLayout = VertexLayout::Interleaved;
+		VertexFormat _vertexFormat;
+		Mesh _mesh;
+		World _world;
+		std::vector<RenderItem> _drawCandidates;
+		std::vector<DrawCommand> _drawList;
+		RenderQueue _renderQueue;
+		BindlessHeap _bindlessHeap;
+
+		/* Per draw data of the frame being recorded, each frame's buffer is registered with the bindless heap */
+		FrameAllocator _frameAllocator;
+		VkDeviceSize _frameAllocatorSize = 16 * 1024 * 1024;
+		std::vector<uint32_t> _frameAllocatorIndices;
+		ParallelRecorder _recorder;
+		uint32_t _recordBenchmarkDraws = 0;
+
+		/* Bounds of the draw candidates as structure of arrays, element i belongs to _drawCandidates[i] */
+		std::vector<float> _boundsX;
+		std::vector<float> _boundsY;
+		std::vector<float> _boundsZ;
+		std::vector<float> _boundsRadius;
+		FrustumCuller _culler;
+		CullKernel _cullKernel = CullKernel::Avx2;
+		bool _frustumCulling = false;
+		float _viewProjection[16] = {
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f,
+		};
+
+		/* Objects live in a storage buffer, culled and turned into indirect draws on the GPU */
+		IndirectRenderer _indirectRenderer;
+		bool _gpuDriven = false;
+
+		std::string _assetPackPath;
+		AssetPack _assetPack;
+		ShaderLibrary _shaderLibrary;
+		bool _shaderHotReload = false;
+		std::string _shaderSourceDirectory = "resources/shader";
+		std::string _shaderCompiler = "glslc";
+		VkPipelineCache _pipelineCache = VK_NULL_HANDLE;
+		std::string _pipelineCachePath = "pipeline_cache.bin";
+		bool _pipelineCacheWarm = false;
+		std::vector<char> _pipelineCacheData;
 		std::vector<VkFramebuffer> _swapChainFrameBuffers;
 
+		uint32_t _framesInFlight = 2;
+		uint32_t _currentFrame = 0;
+		std::vector<FrameData> _frames;
+		std::vector<VkFence> _imagesInFlight;
+		/* One per swap chain image, a present only waits on the semaphore of its image so a slot can't signal it again too early */
+		std::vector<VkSemaphore> _renderFinishedSemaphores;
+		FrameTiming _frameTiming;
+
+		JobSystem _jobSystem;
+		uint32_t _jobThreads = 0;
+
+		Profiler* _profiler = nullptr;
+		GpuProfiler _graphicsProfiler;
+		GpuProfiler _computeProfiler;
+		bool _profilerEnabled = false;
+		std::string _profileTracePath;
+		uint32_t _profileFrames = 120;
+
 		SDL_Window* _window = nullptr;
+		Uint32 _sdlSubsystems = SDL_INIT_VIDEO;
+		bool _headless = false;
+		VkExtent2D _headlessExtent = { 640, 480 };
+
+		std::chrono::steady_clock::time_point _startupBegin;
+		bool _firstFramePresented = false;
 
 		const std::vector<const char*> _validationLayers = {
 			"VK_LAYER_KHRONOS_validation"
@@ -149,14 +355,39 @@ namespace engine
 		int calculatePhysicalDeviceScore(const VkPhysicalDevice& device);
 		bool isDeviceSuitable(const VkPhysicalDevice& device);
 		bool checkDeviceExtensionSupport(const VkPhysicalDevice& device);
+		bool checkVulkan12FeatureSupport(const VkPhysicalDevice& device);
+		bool checkDynamicRenderingSupport(const VkPhysicalDevice& device);
 		QueueFamilyIndicies findQueueFamilyIndices(const VkPhysicalDevice& device);
 		SwapChainSupportDetails querySwapChainSupport(const VkPhysicalDevice& device);
 
 		VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 		VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
 		VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
-
-		VkShaderModule createShaderModule(const std::vector<char>& code);
+		VkExtent2D getDrawableExtent() const;
+
+		VkShaderModule createShaderModule(std::span<const uint32_t> code);
+		VkShaderModule loadShaderModule(const std::string_view& path);
+		VkPipeline buildComputePipeline(const std::string_view& shaderPath, VkPipelineLayout layout);
+		void reloadShaders();
+		void destroyGraphicsPipelines();
+		void populateScene();
+		void buildDrawList();
+		void sortDrawList(std::span<const uint32_t> visible);
+		void cullScene();
+		void buildIndirectScene();
+
+		void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		void recordFrameGraph(VkCommandBuffer commandBuffer, uint32_t imageIndex, const RecordContext& context);
+		void recordMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, const RecordContext& context);
+		void beginMainPass(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondaries);
+		void endMainPass(VkCommandBuffer commandBuffer);
+		void createRenderFinishedSemaphores();
+		void destroyFrameResources();
+		void destroySwapChainResources();
+
+		bool isPipelineCacheCompatible(const std::vector<char>& data);
+		void savePipelineCache();
+		void exportProfile();
 	};
 };
 
@@ -0,0 +1,154 @@
+#include "Mesh.h"
+
+#include <vector>
+#include <limits>
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+namespace engine
+{
+	namespace
+	{
+		/**
+		* create index buffer and queue its upload
+		*/
+		void createIndexBuffer(MemoryAllocator& allocator, UploadQueue& uploadQueue, Mesh& mesh, const void* indices, uint32_t indexCount, VkIndexType indexType)
+		{
+			VkDeviceSize size = static_cast<VkDeviceSize>(indexCount) * (indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+			mesh.indexType = indexType;
+			mesh.indexCount = indexCount;
+			mesh.indexBuffer = allocator.createBuffer(size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh.indexAllocation);
+			mesh.ticket = uploadQueue.uploadBuffer(mesh.indexBuffer, 0, indices, size);
+		}
+	}
+
+	/**
+	* create device local buffers in the format's layout and queue their upload
+	* 16-bit indices are used whenever every vertex is addressable by them
+	*/
+	Mesh createMesh(MemoryAllocator& allocator, UploadQueue& uploadQueue, const VertexFormat& format, const void* vertices, uint32_t vertexCount, std::span<const uint32_t> indices)
+	{
+		Mesh mesh;
+		mesh.vertexCount = vertexCount;
+		mesh.indexCount = static_cast<uint32_t>(indices.size());
+
+		std::vector<std::vector<char>> streams = format.split(vertices, vertexCount);
+		mesh.vertexBufferCount = static_cast<uint32_t>(streams.size());
+
+		for (size_t i = 0; const std::vector<char>& stream : streams)
+		{
+			mesh.vertexBuffers[i] = allocator.createBuffer(stream.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh.vertexAllocations[i]);
+			mesh.ticket = uploadQueue.uploadBuffer(mesh.vertexBuffers[i], 0, stream.data(), stream.size());
+			i++;
+		}
+
+		if (indices.empty())
+		{
+			return mesh;
+		}
+
+		if (vertexCount <= static_cast<uint32_t>(std::numeric_limits<uint16_t>::max()) + 1)
+		{
+			std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+			createIndexBuffer(allocator, uploadQueue, mesh, shortIndices.data(), mesh.indexCount, VK_INDEX_TYPE_UINT16);
+		}
+		else
+		{
+			createIndexBuffer(allocator, uploadQueue, mesh, indices.data(), mesh.indexCount, VK_INDEX_TYPE_UINT32);
+		}
+
+		return mesh;
+	}
+
+	/**
+	* create mesh from a mapped asset, interleaved vertices and indices go from the mapping straight to staging
+	*/
+	Mesh createMesh(MemoryAllocator& allocator, UploadQueue& uploadQueue, const VertexFormat& format, const MeshAsset& asset)
+	{
+		if (asset.vertexStride != format.getSourceStride())
+		{
+			throw std::runtime_error(std::format("mesh asset stride mismatch, asset={}, format={}", asset.vertexStride, format.getSourceStride()));
+		}
+
+		Mesh mesh;
+		mesh.vertexCount = asset.vertexCount;
+
+		if (format.getLayout() == VertexLayout::Interleaved)
+		{
+			VkDeviceSize size = static_cast<VkDeviceSize>(asset.vertexCount) * asset.vertexStride;
+
+			mesh.vertexBufferCount = 1;
+			mesh.vertexBuffers[0] = allocator.createBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh.vertexAllocations[0]);
+			mesh.ticket = uploadQueue.uploadBuffer(mesh.vertexBuffers[0], 0, asset.vertices, size);
+		}
+		else
+		{
+			std::vector<std::vector<char>> streams = format.split(asset.vertices, asset.vertexCount);
+			mesh.vertexBufferCount = static_cast<uint32_t>(streams.size());
+
+			for (size_t i = 0; const std::vector<char>& stream : streams)
+			{
+				mesh.vertexBuffers[i] = allocator.createBuffer(stream.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, mesh.vertexAllocations[i]);
+				mesh.ticket = uploadQueue.uploadBuffer(mesh.vertexBuffers[i], 0, stream.data(), stream.size());
+				i++;
+			}
+		}
+
+		if (asset.indexCount > 0)
+		{
+			createIndexBuffer(allocator, uploadQueue, mesh, asset.indices, asset.indexCount, asset.indexType);
+		}
+
+		return mesh;
+	}
+
+	/**
+	* destroy mesh buffers, the mesh must no longer be in use by the GPU
+	*/
+	void destroyMesh(MemoryAllocator& allocator, Mesh& mesh)
+	{
+		for (uint32_t i = 0; i < mesh.vertexBufferCount; i++)
+		{
+			allocator.destroyBuffer(mesh.vertexBuffers[i], mesh.vertexAllocations[i]);
+		}
+
+		if (mesh.indexBuffer != VK_NULL_HANDLE)
+		{
+			allocator.destroyBuffer(mesh.indexBuffer, mesh.indexAllocation);
+		}
+
+		mesh = Mesh{};
+	}
+
+	/**
+	* bind the first vertexBufferCount streams and the index buffer
+	* a position-only pipeline over a deinterleaved mesh binds only stream 0
+	*/
+	void bindMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, uint32_t vertexBufferCount)
+	{
+		VkDeviceSize offsets[2] = { 0, 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, std::min(vertexBufferCount, mesh.vertexBufferCount), mesh.vertexBuffers.data(), offsets);
+
+		if (mesh.indexBuffer != VK_NULL_HANDLE)
+		{
+			vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer, 0, mesh.indexType);
+		}
+	}
+
+	/**
+	* draw a bound mesh
+	*/
+	void drawMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, uint32_t instanceCount, uint32_t firstInstance)
+	{
+		if (mesh.indexBuffer != VK_NULL_HANDLE)
+		{
+			vkCmdDrawIndexed(commandBuffer, mesh.indexCount, instanceCount, 0, 0, firstInstance);
+		}
+		else
+		{
+			vkCmdDraw(commandBuffer, mesh.vertexCount, instanceCount, 0, firstInstance);
+		}
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef _ENGINE_MESH_HEADER_
+#define _ENGINE_MESH_HEADER_
+
+#include <array>
+#include <span>
+
+#include <vulkan/vulkan.h>
+
+#include "VertexFormat.h"
+#include "../Memory/MemoryAllocator.h"
+#include "../Upload/UploadQueue.h"
+#include "../Asset/AssetPack.h"
+
+namespace engine
+{
+	/**
+	* Device local vertex streams and index buffer
+	*/
+	struct Mesh
+	{
+		std::array<VkBuffer, 2> vertexBuffers = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		std::array<Allocation, 2> vertexAllocations;
+		uint32_t vertexBufferCount = 0;
+		uint32_t vertexCount = 0;
+
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		Allocation indexAllocation;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		uint32_t indexCount = 0;
+
+		UploadTicket ticket;
+	};
+
+	Mesh createMesh(MemoryAllocator& allocator, UploadQueue& uploadQueue, const VertexFormat& format, const void* vertices, uint32_t vertexCount, std::span<const uint32_t> indices);
+	Mesh createMesh(MemoryAllocator& allocator, UploadQueue& uploadQueue, const VertexFormat& format, const MeshAsset& asset);
+	void destroyMesh(MemoryAllocator& allocator, Mesh& mesh);
+
+	void bindMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, uint32_t vertexBufferCount);
+	void drawMesh(VkCommandBuffer commandBuffer, const Mesh& mesh, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+}
+
+#endif // !_ENGINE_MESH_HEADER_
@@ -0,0 +1,160 @@
+#include "VertexFormat.h"
+
+#include <format>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+namespace engine
+{
+	/**
+	* build binding and attribute descriptions for the requested layout
+	*/
+	VertexFormat::VertexFormat(std::initializer_list<VertexAttribute> attributes, VertexLayout layout)
+		: _attributes(attributes), _layout(layout)
+	{
+		for (const VertexAttribute& attribute : _attributes)
+		{
+			_sourceOffsets.push_back(_sourceStride);
+			_sourceStride += getFormatSize(attribute.format);
+		}
+
+		bool hasPosition = std::find_if(_attributes.begin(), _attributes.end(), [](const VertexAttribute& attribute) {
+			return attribute.semantic == VertexSemantic::Position;
+		}) != _attributes.end();
+
+		/* A deinterleaved format without a position stream, or with nothing else, degenerates to interleaved */
+		if (!hasPosition || _attributes.size() == 1)
+		{
+			_layout = VertexLayout::Interleaved;
+		}
+
+		uint32_t bindingCount = _layout == VertexLayout::Deinterleaved ? 2 : 1;
+		std::vector<uint32_t> strides(bindingCount, 0);
+
+		for (const VertexAttribute& attribute : _attributes)
+		{
+			uint32_t binding = bindingOf(attribute);
+
+			_attributeDescriptions.push_back(VkVertexInputAttributeDescription{
+				.location = attribute.location,
+				.binding = binding,
+				.format = attribute.format,
+				.offset = strides[binding],
+			});
+
+			strides[binding] += getFormatSize(attribute.format);
+		}
+
+		for (uint32_t binding = 0; binding < bindingCount; binding++)
+		{
+			_bindings.push_back(VkVertexInputBindingDescription{
+				.binding = binding,
+				.stride = strides[binding],
+				.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+			});
+		}
+	}
+
+	/**
+	* pipeline vertex input state, pointers stay valid as long as this format lives
+	*/
+	VkPipelineVertexInputStateCreateInfo VertexFormat::getInputState() const
+	{
+		return VkPipelineVertexInputStateCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.vertexBindingDescriptionCount = static_cast<uint32_t>(_bindings.size()),
+			.pVertexBindingDescriptions = _bindings.empty() ? nullptr : _bindings.data(),
+			.vertexAttributeDescriptionCount = static_cast<uint32_t>(_attributeDescriptions.size()),
+			.pVertexAttributeDescriptions = _attributeDescriptions.empty() ? nullptr : _attributeDescriptions.data(),
+		};
+	}
+
+	/**
+	* split interleaved source vertices into one buffer per binding
+	*/
+	std::vector<std::vector<char>> VertexFormat::split(const void* vertices, uint32_t vertexCount) const
+	{
+		std::vector<std::vector<char>> streams(_bindings.size());
+		for (size_t binding = 0; binding < _bindings.size(); binding++)
+		{
+			streams[binding].resize(static_cast<size_t>(_bindings[binding].stride) * vertexCount);
+		}
+
+		if (_layout == VertexLayout::Interleaved)
+		{
+			std::memcpy(streams[0].data(), vertices, streams[0].size());
+			return streams;
+		}
+
+		const char* source = static_cast<const char*>(vertices);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			for (size_t i = 0; i < _attributes.size(); i++)
+			{
+				const VkVertexInputAttributeDescription& description = _attributeDescriptions[i];
+				uint32_t stride = _bindings[description.binding].stride;
+
+				std::memcpy(
+					streams[description.binding].data() + static_cast<size_t>(stride) * vertex + description.offset,
+					source + static_cast<size_t>(_sourceStride) * vertex + _sourceOffsets[i],
+					getFormatSize(description.format));
+			}
+		}
+
+		return streams;
+	}
+
+	/**
+	* format reading only the position stream, for depth-only passes over deinterleaved meshes
+	*/
+	VertexFormat VertexFormat::positionOnly() const
+	{
+		for (const VertexAttribute& attribute : _attributes)
+		{
+			if (attribute.semantic == VertexSemantic::Position)
+			{
+				return VertexFormat({ attribute }, VertexLayout::Interleaved);
+			}
+		}
+
+		throw std::runtime_error(std::format("vertex format has no position attribute"));
+	}
+
+	/**
+	* size in bytes of a vertex attribute format
+	*/
+	uint32_t VertexFormat::getFormatSize(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32_UINT:
+			return 4;
+
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			return 8;
+
+		case VK_FORMAT_R32G32B32_SFLOAT:
+			return 12;
+
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return 16;
+
+		default:
+			throw std::runtime_error(std::format("unsupported vertex format: {}", static_cast<int>(format)));
+		}
+	}
+
+	/**
+	* parse vertex layout name from config
+	*/
+	VertexLayout VertexFormat::parseLayout(const std::string_view name)
+	{
+		return name == "deinterleaved" ? VertexLayout::Deinterleaved : VertexLayout::Interleaved;
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef _ENGINE_VERTEX_FORMAT_HEADER_
+#define _ENGINE_VERTEX_FORMAT_HEADER_
+
+#include <vector>
+#include <string_view>
+#include <initializer_list>
+
+#include <vulkan/vulkan.h>
+
+namespace engine
+{
+	enum class VertexSemantic : uint32_t
+	{
+		Position,
+		Normal,
+		Color,
+		TexCoord,
+	};
+
+	/**
+	* Interleaved keeps every attribute in one stream
+	* Deinterleaved splits position into its own stream so position-only passes fetch 12 bytes per vertex
+	*/
+	enum class VertexLayout : uint32_t
+	{
+		Interleaved,
+		Deinterleaved,
+	};
+
+	struct VertexAttribute
+	{
+		VertexSemantic semantic;
+		VkFormat format;
+		uint32_t location;
+	};
+
+	/**
+	* Vertex format descriptor, generates pipeline vertex input state and splits vertex data into streams
+	* source vertex data is always interleaved in attribute order
+	*/
+	class VertexFormat
+	{
+	public:
+		VertexFormat() = default;
+		VertexFormat(std::initializer_list<VertexAttribute> attributes, VertexLayout layout);
+
+		VkPipelineVertexInputStateCreateInfo getInputState() const;
+		std::vector<std::vector<char>> split(const void* vertices, uint32_t vertexCount) const;
+		VertexFormat positionOnly() const;
+
+		constexpr const VertexLayout getLayout() const { return _layout; }
+		constexpr const uint32_t getSourceStride() const { return _sourceStride; }
+		const uint32_t getBindingCount() const { return static_cast<uint32_t>(_bindings.size()); }
+		const uint32_t getStride(uint32_t binding) const { return _bindings[binding].stride; }
+		const std::vector<VkVertexInputBindingDescription>& getBindings() const { return _bindings; }
+		const std::vector<VkVertexInputAttributeDescription>& getAttributes() const { return _attributeDescriptions; }
+
+		static uint32_t getFormatSize(VkFormat format);
+		static VertexLayout parseLayout(const std::string_view name);
+
+	protected:
+
+	private:
+		std::vector<VertexAttribute> _attributes;
+		std::vector<uint32_t> _sourceOffsets;
+		VertexLayout _layout = VertexLayout::Interleaved;
+		uint32_t _sourceStride = 0;
+
+		std::vector<VkVertexInputBindingDescription> _bindings;
+		std::vector<VkVertexInputAttributeDescription> _attributeDescriptions;
+
+		constexpr const uint32_t bindingOf(const VertexAttribute& attribute) const
+		{
+			return _layout == VertexLayout::Deinterleaved && attribute.semantic != VertexSemantic::Position ? 1 : 0;
+		}
+	};
+}
+
+#endif // !_ENGINE_VERTEX_FORMAT_HEADER_
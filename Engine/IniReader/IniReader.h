@@ -4,9 +4,9 @@
 #include <ini.h>
 #include <INIReader.h>
 
-#include "../Prototype/Singleton.hpp"
+#include "../Prototype/ServiceRegistry.hpp"
 
-class IniReader : public Singleton<IniReader>
+class IniReader : public Service<IniReader>
 {
 public:
 	IniReader();
@@ -15,7 +15,7 @@ public:
 	/**
 	* get actual INIReader
 	*/
-	const INIReader getReader() { return _reader;  }
+	const INIReader& getReader() const { return _reader; }
 
 protected:
 
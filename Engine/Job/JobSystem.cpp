@@ -0,0 +1,297 @@
+#include "JobSystem.h"
+
+#include <format>
+#include <algorithm>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		thread_local const JobSystem* currentSystem = nullptr;
+		thread_local uint32_t currentThreadIndex = 0;
+	}
+
+	/**
+	* join workers
+	*/
+	JobSystem::~JobSystem()
+	{
+		destroy();
+	}
+
+	/**
+	* create one deque per thread and start threadCount - 1 workers
+	*/
+	void JobSystem::init(uint32_t threadCount)
+	{
+		threadCount = std::max(threadCount, 1u);
+
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			_queues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		/* A system created from inside another one's job must not take over that thread's index for good */
+		_previousSystem = currentSystem;
+		_previousThreadIndex = currentThreadIndex;
+		currentSystem = this;
+		currentThreadIndex = 0;
+
+		_stop = false;
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			_workers.emplace_back(&JobSystem::workerLoop, this, i);
+		}
+
+		spdlog::debug(std::format("created job system, threads={}", threadCount));
+	}
+
+	/**
+	* run the remaining jobs and join workers
+	*/
+	void JobSystem::destroy()
+	{
+		if (_queues.empty())
+		{
+			return;
+		}
+
+		while (_queuedJobs.load(std::memory_order_acquire) > 0)
+		{
+			if (!tryRunJob(getThreadIndex()))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stop = true;
+		}
+		_wake.notify_all();
+
+		for (std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+		_workers.clear();
+		_queues.clear();
+
+		if (!_parked.empty())
+		{
+			spdlog::warn(std::format("dropping jobs whose dependency never finished, jobs={}", _parked.size()));
+		}
+		_parked.clear();
+
+		if (currentSystem == this)
+		{
+			currentSystem = _previousSystem;
+			currentThreadIndex = _previousThreadIndex;
+		}
+	}
+
+	/**
+	* push a job onto the calling thread's deque, counter is decremented when it finished
+	* a job with an unfinished dependency is parked instead and queued once the dependency drops to zero
+	*/
+	void JobSystem::run(std::function<void()> function, JobCounter* counter, const JobCounter* dependency)
+	{
+		if (counter != nullptr)
+		{
+			counter->value.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		Job job{
+			.function = std::move(function),
+			.counter = counter,
+			.dependency = dependency,
+		};
+
+		if (dependency != nullptr)
+		{
+			/* Checked under the lock the releasing thread takes after its decrement, the job cannot miss its release */
+			std::lock_guard<std::mutex> lock(_parkedMutex);
+			if (!dependency->isDone())
+			{
+				_parked.push_back(std::move(job));
+				return;
+			}
+		}
+
+		push(getThreadIndex(), std::move(job));
+	}
+
+	/**
+	* run queued jobs until counter reaches zero, sleeps while no job is queued
+	*/
+	void JobSystem::wait(const JobCounter& counter)
+	{
+		uint32_t threadIndex = getThreadIndex();
+
+		while (!counter.isDone())
+		{
+			if (tryRunJob(threadIndex))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wake.wait(lock, [this, &counter]() { return counter.isDone() || _queuedJobs.load(std::memory_order_acquire) > 0; });
+		}
+	}
+
+	/**
+	* deque index of the calling thread, threads outside the system share the deque of the init thread
+	*/
+	uint32_t JobSystem::getThreadIndex() const
+	{
+		return currentSystem == this ? currentThreadIndex : 0;
+	}
+
+	/**
+	* worker: run jobs, sleep when every deque is empty
+	*/
+	void JobSystem::workerLoop(uint32_t threadIndex)
+	{
+		currentSystem = this;
+		currentThreadIndex = threadIndex;
+
+		while (!_stop.load(std::memory_order_acquire))
+		{
+			if (tryRunJob(threadIndex))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wake.wait(lock, [this]() { return _stop.load(std::memory_order_acquire) || _queuedJobs.load(std::memory_order_acquire) > 0; });
+		}
+	}
+
+	/**
+	* run one job from the own deque or stolen from another, returns false when none was found
+	*/
+	bool JobSystem::tryRunJob(uint32_t threadIndex)
+	{
+		Job job;
+		if (!popJob(threadIndex, job))
+		{
+			return false;
+		}
+
+		execute(job);
+
+		return true;
+	}
+
+	/**
+	* newest job of the own deque first for cache locality, otherwise the oldest job of a victim
+	*/
+	bool JobSystem::popJob(uint32_t threadIndex, Job& job)
+	{
+		{
+			WorkQueue& queue = *_queues[threadIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.jobs.empty())
+			{
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+				_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+				return true;
+			}
+		}
+
+		for (size_t offset = 1; offset < _queues.size(); offset++)
+		{
+			WorkQueue& victim = *_queues[(threadIndex + offset) % _queues.size()];
+			std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+			if (lock.owns_lock() && !victim.jobs.empty())
+			{
+				job = std::move(victim.jobs.front());
+				victim.jobs.pop_front();
+				_queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	* append a runnable job to a deque and wake a sleeping thread
+	*/
+	void JobSystem::push(uint32_t threadIndex, Job&& job)
+	{
+		WorkQueue& queue = *_queues[threadIndex];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(job));
+		}
+
+		_queuedJobs.fetch_add(1, std::memory_order_release);
+
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+		_wake.notify_one();
+	}
+
+	/**
+	* run a job and signal its counter, the last job of a counter releases the jobs parked on it
+	*/
+	void JobSystem::execute(Job& job)
+	{
+		try
+		{
+			job.function();
+		}
+		catch (...)
+		{
+			bool expected = false;
+			if (job.counter != nullptr && job.counter->failed.compare_exchange_strong(expected, true))
+			{
+				job.counter->error = std::current_exception();
+			}
+			else
+			{
+				spdlog::error(std::format("unhandled exception in job"));
+			}
+		}
+
+		/* The waiter may destroy the counter as soon as it reads zero, nothing below touches it */
+		if (job.counter != nullptr && job.counter->value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			releaseParked(getThreadIndex());
+
+			/* Threads in wait sleep on the counter, not only on queued jobs */
+			{
+				std::lock_guard<std::mutex> lock(_sleepMutex);
+			}
+			_wake.notify_all();
+		}
+	}
+
+	/**
+	* queue every parked job whose dependency finished
+	*/
+	void JobSystem::releaseParked(uint32_t threadIndex)
+	{
+		std::vector<Job> released;
+		{
+			std::lock_guard<std::mutex> lock(_parkedMutex);
+			std::vector<Job> waiting;
+			for (Job& job : _parked)
+			{
+				(job.dependency->isDone() ? released : waiting).push_back(std::move(job));
+			}
+			_parked = std::move(waiting);
+		}
+
+		for (Job& job : released)
+		{
+			push(threadIndex, std::move(job));
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#ifndef _ENGINE_JOB_SYSTEM_HEADER_
+#define _ENGINE_JOB_SYSTEM_HEADER_
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace engine
+{
+	/**
+	* Counts unfinished jobs, a job depending on it is parked until it drops to zero
+	* the first exception thrown by one of its jobs is kept for the waiter
+	*/
+	struct JobCounter
+	{
+		std::atomic<uint32_t> value = 0;
+		std::atomic<bool> failed = false;
+		std::exception_ptr error;
+
+		bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+	};
+
+	/**
+	* Scheduled unit of work
+	*/
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+		const JobCounter* dependency = nullptr;
+	};
+
+	/**
+	* Work-stealing scheduler with one deque per thread
+	* owners push and pop at the back, idle threads steal from the front of other deques
+	* the thread calling init is worker 0 and only runs jobs while it waits
+	*/
+	class JobSystem
+	{
+	public:
+		JobSystem() = default;
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		void init(uint32_t threadCount);
+		void destroy();
+
+		void run(std::function<void()> function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr);
+		void wait(const JobCounter& counter);
+
+		template <typename Function>
+		void parallelFor(size_t begin, size_t end, size_t grainSize, Function&& function);
+
+		constexpr const uint32_t getThreadCount() const { return static_cast<uint32_t>(_queues.size()); }
+		uint32_t getThreadIndex() const;
+
+	protected:
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		std::vector<std::unique_ptr<WorkQueue>> _queues;
+		std::vector<std::thread> _workers;
+
+		std::mutex _sleepMutex;
+		std::condition_variable _wake;
+		std::atomic<uint32_t> _queuedJobs = 0;
+		std::atomic<bool> _stop = false;
+
+		/* Jobs whose dependency was unfinished when they were run, released when a counter drops to zero */
+		std::mutex _parkedMutex;
+		std::vector<Job> _parked;
+
+		const JobSystem* _previousSystem = nullptr;
+		uint32_t _previousThreadIndex = 0;
+
+		void workerLoop(uint32_t threadIndex);
+		bool tryRunJob(uint32_t threadIndex);
+		bool popJob(uint32_t threadIndex, Job& job);
+		void push(uint32_t threadIndex, Job&& job);
+		void execute(Job& job);
+		void releaseParked(uint32_t threadIndex);
+	};
+
+	/**
+	* split [begin, end) into chunks of at most grainSize and call function(first, last) for each, blocks until all chunks ran
+	*/
+	template <typename Function>
+	void JobSystem::parallelFor(size_t begin, size_t end, size_t grainSize, Function&& function)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+
+		grainSize = grainSize == 0 ? 1 : grainSize;
+		if (end - begin <= grainSize || _queues.size() <= 1)
+		{
+			function(begin, end);
+			return;
+		}
+
+		JobCounter counter;
+		for (size_t first = begin; first < end; first += grainSize)
+		{
+			size_t last = first + grainSize < end ? first + grainSize : end;
+			run([&function, first, last]() { function(first, last); }, &counter);
+		}
+
+		wait(counter);
+
+		if (counter.error != nullptr)
+		{
+			std::rethrow_exception(counter.error);
+		}
+	}
+}
+
+#endif // !_ENGINE_JOB_SYSTEM_HEADER_
@@ -0,0 +1,222 @@
+#include "StartupGraph.h"
+
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* add stage, dependencies have to be added before their dependents
+	*/
+	void StartupGraph::add(const std::string_view name, std::function<void()> function, std::initializer_list<std::string_view> dependencies, StageThread thread)
+	{
+		size_t index = _stages.size();
+
+		_stages.push_back(Stage{
+			.name = std::string(name),
+			.function = std::move(function),
+			.thread = thread,
+			.remaining = static_cast<uint32_t>(dependencies.size()),
+		});
+
+		for (std::string_view dependency : dependencies)
+		{
+			size_t dependencyIndex = findStage(dependency);
+			if (dependencyIndex >= index)
+			{
+				throw std::runtime_error(std::format("unknown startup stage dependency, stage={}, dependency={}", name, dependency));
+			}
+
+			_stages[dependencyIndex].dependents.push_back(index);
+		}
+	}
+
+	/**
+	* run every stage and log its timing, rethrows the first stage failure once running stages finished
+	*/
+	void StartupGraph::run(JobSystem& jobSystem)
+	{
+		_jobSystem = &jobSystem;
+		_begin = std::chrono::steady_clock::now();
+		_finished = 0;
+		_error = nullptr;
+
+		/* Without workers the main thread would sleep on jobs nobody runs, run every stage on it instead */
+		if (!_serial && jobSystem.getThreadCount() <= 1)
+		{
+			spdlog::info(std::format("startup runs serially, the job system has no worker threads, threads={}", jobSystem.getThreadCount()));
+			_serial = true;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (size_t i = 0; i < _stages.size(); i++)
+			{
+				if (_stages[i].remaining == 0)
+				{
+					schedule(i);
+				}
+			}
+		}
+
+		for (;;)
+		{
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_progress.wait(lock, [this]() { return !_mainReady.empty() || _finished == _stages.size(); });
+
+				if (_mainReady.empty())
+				{
+					break;
+				}
+
+				index = _mainReady.front();
+				_mainReady.erase(_mainReady.begin());
+			}
+
+			execute(index);
+		}
+
+		std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - _begin;
+
+		double serial = 0.0;
+		for (const StageTiming& stage : getTimings())
+		{
+			if (stage.skipped)
+			{
+				spdlog::info(std::format("startup stage {:<20} skipped", stage.name));
+				continue;
+			}
+
+			serial += stage.duration;
+			spdlog::info(std::format("startup stage {:<20} start={:8.3f}ms, duration={:8.3f}ms, thread={}", stage.name, stage.begin, stage.duration, stage.thread == StageThread::Main ? "main" : "any"));
+		}
+
+		spdlog::info(std::format("startup finished in {:.3f}ms, stages took {:.3f}ms combined", total.count(), serial));
+
+		if (_error != nullptr)
+		{
+			std::rethrow_exception(_error);
+		}
+	}
+
+	/**
+	* stage timings in start order, valid after run
+	*/
+	std::vector<StageTiming> StartupGraph::getTimings() const
+	{
+		std::vector<StageTiming> timings;
+		timings.reserve(_stages.size());
+
+		for (const Stage& stage : _stages)
+		{
+			timings.push_back(StageTiming{
+				.name = stage.name,
+				.thread = stage.thread,
+				.skipped = stage.skipped,
+				.begin = stage.begin,
+				.duration = stage.duration,
+			});
+		}
+
+		std::sort(timings.begin(), timings.end(), [](const StageTiming& a, const StageTiming& b) { return a.begin < b.begin; });
+
+		return timings;
+	}
+
+	/**
+	* index of stage by name, stage count when it does not exist
+	*/
+	size_t StartupGraph::findStage(const std::string_view name) const
+	{
+		for (size_t i = 0; i < _stages.size(); i++)
+		{
+			if (_stages[i].name == name)
+			{
+				return i;
+			}
+		}
+
+		return _stages.size();
+	}
+
+	/**
+	* hand a stage whose dependencies finished to the main thread or the job system, _mutex is held
+	*/
+	void StartupGraph::schedule(size_t index)
+	{
+		if (_serial || _stages[index].thread == StageThread::Main)
+		{
+			_mainReady.push_back(index);
+			_progress.notify_one();
+			return;
+		}
+
+		_jobSystem->run([this, index]() { execute(index); });
+	}
+
+	/**
+	* run stage and release its dependents
+	*/
+	void StartupGraph::execute(size_t index)
+	{
+		Stage& stage = _stages[index];
+
+		std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		std::exception_ptr error;
+		try
+		{
+			stage.function();
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		stage.begin = std::chrono::duration<double, std::milli>(begin - _begin).count();
+		stage.duration = std::chrono::duration<double, std::milli>(end - begin).count();
+		_finished++;
+
+		if (error != nullptr)
+		{
+			_error = _error == nullptr ? error : _error;
+			spdlog::error(std::format("startup stage failed, stage={}", stage.name));
+			skipDependents(index);
+		}
+		else
+		{
+			for (size_t dependent : stage.dependents)
+			{
+				if (--_stages[dependent].remaining == 0 && !_stages[dependent].skipped)
+				{
+					schedule(dependent);
+				}
+			}
+		}
+
+		_progress.notify_one();
+	}
+
+	/**
+	* mark every transitive dependent of a failed stage as finished without running it, _mutex is held
+	*/
+	void StartupGraph::skipDependents(size_t index)
+	{
+		for (size_t dependent : _stages[index].dependents)
+		{
+			if (!_stages[dependent].skipped)
+			{
+				_stages[dependent].skipped = true;
+				_finished++;
+				skipDependents(dependent);
+			}
+		}
+	}
+}
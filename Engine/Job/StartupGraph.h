@@ -0,0 +1,82 @@
+#ifndef _ENGINE_STARTUP_GRAPH_HEADER_
+#define _ENGINE_STARTUP_GRAPH_HEADER_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <condition_variable>
+
+#include "JobSystem.h"
+
+namespace engine
+{
+	enum class StageThread
+	{
+		Any,
+		Main,
+	};
+
+	/**
+	* Measured stage, times are milliseconds since the graph started running
+	*/
+	struct StageTiming
+	{
+		std::string name;
+		StageThread thread;
+		bool skipped;
+		double begin;
+		double duration;
+	};
+
+	/**
+	* Startup expressed as stages with dependencies
+	* a stage is scheduled as soon as its dependencies finished, stages bound to the main thread run on the thread calling run
+	* serial graphs run every stage on the calling thread in dependency order, so each one is measured in isolation
+	*/
+	class StartupGraph
+	{
+	public:
+		void add(const std::string_view name, std::function<void()> function, std::initializer_list<std::string_view> dependencies = {}, StageThread thread = StageThread::Any);
+		void run(JobSystem& jobSystem);
+
+		void setSerial(const bool serial) { _serial = serial; }
+		std::vector<StageTiming> getTimings() const;
+
+	protected:
+
+	private:
+		struct Stage
+		{
+			std::string name;
+			std::function<void()> function;
+			StageThread thread;
+			std::vector<size_t> dependents;
+			uint32_t remaining = 0;
+			bool skipped = false;
+			double begin = 0.0;
+			double duration = 0.0;
+		};
+
+		std::vector<Stage> _stages;
+
+		bool _serial = false;
+		JobSystem* _jobSystem = nullptr;
+		std::chrono::steady_clock::time_point _begin;
+		std::mutex _mutex;
+		std::condition_variable _progress;
+		std::vector<size_t> _mainReady;
+		size_t _finished = 0;
+		std::exception_ptr _error;
+
+		size_t findStage(const std::string_view name) const;
+		void schedule(size_t index);
+		void execute(size_t index);
+		void skipDependents(size_t index);
+	};
+}
+
+#endif // !_ENGINE_STARTUP_GRAPH_HEADER_
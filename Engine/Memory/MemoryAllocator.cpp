@@ -0,0 +1,636 @@
+#include "MemoryAllocator.h"
+
+#include <format>
+#include <bit>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	/**
+	* initialize free lists, whole block is a single free range of the highest order
+	*/
+	void BuddyBlock::init(uint32_t order)
+	{
+		maxOrder = order;
+		size = minSize << order;
+		usedBytes = 0;
+		allocationCount = 0;
+		freeLists.assign(order + 1, {});
+		freeLists[order].insert(0);
+	}
+
+	/**
+	* take a range of (minSize << order) bytes, splitting larger ranges as needed
+	*/
+	std::optional<VkDeviceSize> BuddyBlock::allocate(uint32_t order)
+	{
+		uint32_t current = order;
+		while (current <= maxOrder && freeLists[current].empty())
+		{
+			current++;
+		}
+
+		if (current > maxOrder)
+		{
+			return std::nullopt;
+		}
+
+		VkDeviceSize offset = *freeLists[current].begin();
+		freeLists[current].erase(freeLists[current].begin());
+
+		while (current > order)
+		{
+			current--;
+			freeLists[current].insert(offset + (minSize << current));
+		}
+
+		usedBytes += minSize << order;
+		allocationCount++;
+
+		return offset;
+	}
+
+	/**
+	* return a range and merge it with its free buddies
+	*/
+	void BuddyBlock::free(VkDeviceSize offset, uint32_t order)
+	{
+		usedBytes -= minSize << order;
+		allocationCount--;
+
+		while (order < maxOrder)
+		{
+			VkDeviceSize buddy = offset ^ (minSize << order);
+			if (freeLists[order].erase(buddy) == 0)
+			{
+				break;
+			}
+
+			offset = std::min(offset, buddy);
+			order++;
+		}
+
+		freeLists[order].insert(offset);
+	}
+
+	/**
+	* size of the largest allocatable range
+	*/
+	VkDeviceSize BuddyBlock::largestFreeRange() const
+	{
+		for (uint32_t order = maxOrder + 1; order > 0; order--)
+		{
+			if (!freeLists[order - 1].empty())
+			{
+				return minSize << (order - 1);
+			}
+		}
+
+		return 0;
+	}
+
+	/**
+	* query memory types and limits of the physical device
+	*/
+	void MemoryAllocator::init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+	{
+		_device = device;
+		_blockSize = std::bit_ceil(std::max(blockSize, BuddyBlock::minSize));
+
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		_limits = properties.limits;
+
+		for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+		{
+			spdlog::debug(std::format("memory type: index={}, heap={}, flags={:#x}", i, _memoryProperties.memoryTypes[i].heapIndex, _memoryProperties.memoryTypes[i].propertyFlags));
+		}
+	}
+
+	/**
+	* release every block and dedicated allocation
+	*/
+	void MemoryAllocator::destroy()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (const std::unique_ptr<BuddyBlock>& block : _blocks)
+		{
+			if (block->allocationCount > 0)
+			{
+				spdlog::warn(std::format("leaked {} allocations in memory block, type={}", block->allocationCount, block->memoryTypeIndex));
+			}
+			freeDeviceMemory(block->memory);
+		}
+		_blocks.clear();
+
+		for (const Allocation& allocation : _dedicatedAllocations)
+		{
+			freeDeviceMemory(allocation.memory);
+		}
+		_dedicatedAllocations.clear();
+	}
+
+	/**
+	* sub-allocate memory satisfying the requirements
+	* linear tells whether the resource is a buffer or linear image, those never share a block with optimal images
+	*/
+	Allocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, bool linear)
+	{
+		uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, required, preferred);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		VkDeviceSize size = std::bit_ceil(std::max({ requirements.size, requirements.alignment, BuddyBlock::minSize }));
+		if (size > _blockSize / 2)
+		{
+			return allocateDedicated(requirements.size, memoryTypeIndex);
+		}
+
+		uint32_t order = static_cast<uint32_t>(std::countr_zero(size / BuddyBlock::minSize));
+
+		for (const std::unique_ptr<BuddyBlock>& block : _blocks)
+		{
+			if (block->memoryTypeIndex != memoryTypeIndex || block->linear != linear)
+			{
+				continue;
+			}
+
+			std::optional<VkDeviceSize> offset = block->allocate(order);
+			if (offset.has_value())
+			{
+				return Allocation{
+					.memory = block->memory,
+					.offset = offset.value(),
+					.size = requirements.size,
+					.mapped = block->mapped == nullptr ? nullptr : static_cast<char*>(block->mapped) + offset.value(),
+					.memoryTypeIndex = memoryTypeIndex,
+					.block = block.get(),
+					.order = order,
+				};
+			}
+		}
+
+		std::unique_ptr<BuddyBlock> block = std::make_unique<BuddyBlock>();
+		block->memoryTypeIndex = memoryTypeIndex;
+		block->linear = linear;
+		block->init(static_cast<uint32_t>(std::countr_zero(_blockSize / BuddyBlock::minSize)));
+		block->memory = allocateDeviceMemory(block->size, memoryTypeIndex, &block->mapped);
+
+		VkDeviceSize offset = block->allocate(order).value();
+
+		Allocation allocation{
+			.memory = block->memory,
+			.offset = offset,
+			.size = requirements.size,
+			.mapped = block->mapped == nullptr ? nullptr : static_cast<char*>(block->mapped) + offset,
+			.memoryTypeIndex = memoryTypeIndex,
+			.block = block.get(),
+			.order = order,
+		};
+
+		_blocks.push_back(std::move(block));
+
+		return allocation;
+	}
+
+	/**
+	* return allocation, empty blocks are released when another block of the same type remains
+	*/
+	void MemoryAllocator::free(Allocation& allocation)
+	{
+		if (!allocation.isValid())
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (allocation.block == nullptr)
+		{
+			std::erase_if(_dedicatedAllocations, [&](const Allocation& dedicated) { return dedicated.memory == allocation.memory; });
+			freeDeviceMemory(allocation.memory);
+		}
+		else
+		{
+			BuddyBlock* block = allocation.block;
+			block->free(allocation.offset, allocation.order);
+
+			if (block->allocationCount == 0)
+			{
+				size_t siblings = std::count_if(_blocks.begin(), _blocks.end(), [&](const std::unique_ptr<BuddyBlock>& other) {
+					return other->memoryTypeIndex == block->memoryTypeIndex && other->linear == block->linear;
+				});
+
+				if (siblings > 1)
+				{
+					freeDeviceMemory(block->memory);
+					std::erase_if(_blocks, [&](const std::unique_ptr<BuddyBlock>& other) { return other.get() == block; });
+				}
+			}
+		}
+
+		allocation = Allocation{};
+	}
+
+	/**
+	* create buffer and bind sub-allocated memory
+	*/
+	VkBuffer MemoryAllocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Allocation& allocation)
+	{
+		VkBufferCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.size = size,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		};
+
+		VkBuffer buffer;
+		if (vkCreateBuffer(_device, &createInfo, nullptr, &buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create buffer, size={}", size));
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetBufferMemoryRequirements(_device, buffer, &requirements);
+
+		allocation = allocate(requirements, required, preferred, true);
+
+		if (vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to bind buffer memory"));
+		}
+
+		return buffer;
+	}
+
+	/**
+	* destroy buffer and return its memory
+	*/
+	void MemoryAllocator::destroyBuffer(VkBuffer buffer, Allocation& allocation)
+	{
+		vkDestroyBuffer(_device, buffer, nullptr);
+		free(allocation);
+	}
+
+	/**
+	* create image and bind sub-allocated memory
+	*/
+	VkImage MemoryAllocator::createImage(const VkImageCreateInfo& createInfo, VkMemoryPropertyFlags required, Allocation& allocation)
+	{
+		VkImage image;
+		if (vkCreateImage(_device, &createInfo, nullptr, &image) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create image"));
+		}
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(_device, image, &requirements);
+
+		allocation = allocate(requirements, required, 0, createInfo.tiling == VK_IMAGE_TILING_LINEAR);
+
+		if (vkBindImageMemory(_device, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to bind image memory"));
+		}
+
+		return image;
+	}
+
+	/**
+	* destroy image and return its memory
+	*/
+	void MemoryAllocator::destroyImage(VkImage image, Allocation& allocation)
+	{
+		vkDestroyImage(_device, image, nullptr);
+		free(allocation);
+	}
+
+	/**
+	* find memory type having required flags, memory types having preferred flags as well win
+	*/
+	uint32_t MemoryAllocator::findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const
+	{
+		std::optional<uint32_t> fallback;
+
+		for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++)
+		{
+			VkMemoryPropertyFlags flags = _memoryProperties.memoryTypes[i].propertyFlags;
+			if ((typeBits & (1u << i)) == 0 || (flags & required) != required)
+			{
+				continue;
+			}
+
+			if ((flags & preferred) == preferred)
+			{
+				return i;
+			}
+
+			if (!fallback.has_value())
+			{
+				fallback = i;
+			}
+		}
+
+		if (!fallback.has_value())
+		{
+			throw std::runtime_error(std::format("failed to find suitable memory type, typeBits={:#x}, flags={:#x}", typeBits, required));
+		}
+
+		return fallback.value();
+	}
+
+	/**
+	* collect per heap usage statistics
+	*/
+	MemoryStats MemoryAllocator::getStats()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		MemoryStats stats;
+		stats.deviceMemoryCount = _deviceMemoryCount;
+		stats.heaps.resize(_memoryProperties.memoryHeapCount);
+
+		for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; i++)
+		{
+			stats.heaps[i].heapSize = _memoryProperties.memoryHeaps[i].size;
+		}
+
+		for (const std::unique_ptr<BuddyBlock>& block : _blocks)
+		{
+			HeapStats& heap = stats.heaps[_memoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex];
+			heap.reservedBytes += block->size;
+			heap.usedBytes += block->usedBytes;
+			heap.largestFreeRange = std::max(heap.largestFreeRange, block->largestFreeRange());
+			heap.blockCount++;
+			heap.allocationCount += block->allocationCount;
+		}
+
+		for (const Allocation& allocation : _dedicatedAllocations)
+		{
+			HeapStats& heap = stats.heaps[_memoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex];
+			heap.reservedBytes += allocation.size;
+			heap.usedBytes += allocation.size;
+			heap.blockCount++;
+			heap.allocationCount++;
+		}
+
+		return stats;
+	}
+
+	/**
+	* log per heap usage statistics
+	*/
+	void MemoryAllocator::logStats()
+	{
+		MemoryStats stats = getStats();
+
+		for (size_t i = 0; const HeapStats& heap : stats.heaps)
+		{
+			spdlog::info(std::format("memory heap {}: reserved={}, used={}, blocks={}, allocations={}, fragmentation={:.2f}, size={}",
+				i, heap.reservedBytes, heap.usedBytes, heap.blockCount, heap.allocationCount, heap.fragmentation(), heap.heapSize));
+			i++;
+		}
+
+		spdlog::info(std::format("device memory objects: {}/{}", stats.deviceMemoryCount, _limits.maxMemoryAllocationCount));
+	}
+
+	/**
+	* allocate VkDeviceMemory, host visible memory stays persistently mapped
+	*/
+	VkDeviceMemory MemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped)
+	{
+		if (_deviceMemoryCount >= _limits.maxMemoryAllocationCount)
+		{
+			throw std::runtime_error(std::format("exceeded maxMemoryAllocationCount={}", _limits.maxMemoryAllocationCount));
+		}
+
+		VkMemoryAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.allocationSize = size,
+			.memoryTypeIndex = memoryTypeIndex,
+		};
+
+		VkDeviceMemory memory;
+		if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to allocate device memory, size={}, type={}", size, memoryTypeIndex));
+		}
+		_deviceMemoryCount++;
+
+		*mapped = nullptr;
+		if (_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to map device memory"));
+			}
+		}
+
+		spdlog::debug(std::format("allocated device memory, size={}, type={}", size, memoryTypeIndex));
+
+		return memory;
+	}
+
+	/**
+	* free VkDeviceMemory, mapped memory is implicitly unmapped
+	*/
+	void MemoryAllocator::freeDeviceMemory(VkDeviceMemory memory)
+	{
+		vkFreeMemory(_device, memory, nullptr);
+		_deviceMemoryCount--;
+	}
+
+	/**
+	* allocate a VkDeviceMemory for a single large resource
+	*/
+	Allocation MemoryAllocator::allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex)
+	{
+		Allocation allocation{
+			.size = size,
+			.memoryTypeIndex = memoryTypeIndex,
+		};
+		allocation.memory = allocateDeviceMemory(size, memoryTypeIndex, &allocation.mapped);
+
+		_dedicatedAllocations.push_back(allocation);
+
+		return allocation;
+	}
+
+	/**
+	* create the pool buffer
+	*/
+	void LinearPool::init(MemoryAllocator& allocator, VkDeviceSize capacity, VkBufferUsageFlags usage, VkMemoryPropertyFlags required)
+	{
+		_buffer = allocator.createBuffer(capacity, usage, required, 0, _allocation);
+		_capacity = capacity;
+		_head = 0;
+	}
+
+	/**
+	* destroy the pool buffer
+	*/
+	void LinearPool::destroy(MemoryAllocator& allocator)
+	{
+		if (_buffer != VK_NULL_HANDLE)
+		{
+			allocator.destroyBuffer(_buffer, _allocation);
+			_buffer = VK_NULL_HANDLE;
+		}
+	}
+
+	/**
+	* bump allocate, returns nullopt when the pool is exhausted
+	*/
+	std::optional<BufferRange> LinearPool::allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		VkDeviceSize offset = alignUp(_head, alignment);
+		if (offset + size > _capacity)
+		{
+			return std::nullopt;
+		}
+
+		_head = offset + size;
+
+		return BufferRange{
+			.buffer = _buffer,
+			.offset = offset,
+			.size = size,
+			.mapped = _allocation.mapped == nullptr ? nullptr : static_cast<char*>(_allocation.mapped) + offset,
+		};
+	}
+
+	/**
+	* create the pool buffer
+	*/
+	void RingPool::init(MemoryAllocator& allocator, VkDeviceSize capacity, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, uint32_t framesInFlight)
+	{
+		_buffer = allocator.createBuffer(capacity, usage, required, 0, _allocation);
+		_capacity = capacity;
+		_head = 0;
+		_usedBytes = 0;
+		_frameIndex = 0;
+		_frameBytes.assign(framesInFlight, 0);
+	}
+
+	/**
+	* destroy the pool buffer
+	*/
+	void RingPool::destroy(MemoryAllocator& allocator)
+	{
+		if (_buffer != VK_NULL_HANDLE)
+		{
+			allocator.destroyBuffer(_buffer, _allocation);
+			_buffer = VK_NULL_HANDLE;
+		}
+	}
+
+	/**
+	* start recording a frame, reclaims everything the previous user of this frame slot allocated
+	* call only after the frame slot's fence signaled
+	*/
+	void RingPool::beginFrame(uint32_t frameIndex)
+	{
+		_frameIndex = frameIndex % static_cast<uint32_t>(_frameBytes.size());
+		_usedBytes -= _frameBytes[_frameIndex];
+		_frameBytes[_frameIndex] = 0;
+
+		if (_usedBytes == 0)
+		{
+			_head = 0;
+		}
+	}
+
+	/**
+	* allocate from the ring, wrapping to the start when the tail has enough room
+	*/
+	std::optional<BufferRange> RingPool::allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		VkDeviceSize offset = alignUp(_head, alignment);
+		VkDeviceSize consumed = offset - _head + size;
+
+		if (offset + size > _capacity)
+		{
+			/* Skip the unusable end of the buffer */
+			offset = 0;
+			consumed = _capacity - _head + size;
+		}
+
+		/* Live data always spans the _usedBytes bytes right behind _head */
+		if (_usedBytes + consumed > _capacity)
+		{
+			return std::nullopt;
+		}
+
+		_head = (offset + size) % _capacity;
+		_usedBytes += consumed;
+		_frameBytes[_frameIndex] += consumed;
+
+		return BufferRange{
+			.buffer = _buffer,
+			.offset = offset,
+			.size = size,
+			.mapped = _allocation.mapped == nullptr ? nullptr : static_cast<char*>(_allocation.mapped) + offset,
+		};
+	}
+
+	/**
+	* create one pool per frame in flight, offsets honor the device's uniform and storage buffer offset alignment
+	*/
+	void FrameAllocator::init(MemoryAllocator& allocator, VkDeviceSize capacity, uint32_t framesInFlight)
+	{
+		const VkPhysicalDeviceLimits& limits = allocator.getLimits();
+		_alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+		_capacity = capacity;
+		_frameIndex = 0;
+
+		_pools.resize(framesInFlight);
+		for (LinearPool& pool : _pools)
+		{
+			pool.init(allocator, capacity, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+	}
+
+	/**
+	* destroy every frame's pool
+	*/
+	void FrameAllocator::destroy(MemoryAllocator& allocator)
+	{
+		for (LinearPool& pool : _pools)
+		{
+			pool.destroy(allocator);
+		}
+		_pools.clear();
+	}
+
+	/**
+	* switch to a frame slot and drop everything allocated the last time it was recorded
+	* call only after the frame slot's fence signaled
+	*/
+	void FrameAllocator::beginFrame(uint32_t frameIndex)
+	{
+		_frameIndex = frameIndex % static_cast<uint32_t>(_pools.size());
+		_pools[_frameIndex].reset();
+	}
+
+	/**
+	* bump allocate from the current frame's pool, returns nullopt when the frame is out of space
+	*/
+	std::optional<BufferRange> FrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		return _pools[_frameIndex].allocate(size, std::max(alignment, _alignment));
+	}
+}
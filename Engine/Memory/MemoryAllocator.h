@@ -0,0 +1,230 @@
+#ifndef _ENGINE_MEMORY_ALLOCATOR_HEADER_
+#define _ENGINE_MEMORY_ALLOCATOR_HEADER_
+
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include <vulkan/vulkan.h>
+
+namespace engine
+{
+	struct BuddyBlock;
+
+	/**
+	* Sub-allocated range of device memory
+	*/
+	struct Allocation
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* mapped = nullptr;
+		uint32_t memoryTypeIndex = UINT32_MAX;
+
+		BuddyBlock* block = nullptr;
+		uint32_t order = 0;
+
+		constexpr const bool isValid() const { return memory != VK_NULL_HANDLE; }
+	};
+
+	/**
+	* Range of a pool buffer handed out for transient data
+	*/
+	struct BufferRange
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* mapped = nullptr;
+	};
+
+	/**
+	* Memory usage of a single memory heap
+	*/
+	struct HeapStats
+	{
+		VkDeviceSize heapSize = 0;
+		VkDeviceSize reservedBytes = 0;
+		VkDeviceSize usedBytes = 0;
+		VkDeviceSize largestFreeRange = 0;
+		uint32_t blockCount = 0;
+		uint32_t allocationCount = 0;
+
+		/**
+		* 0 when all free space is one contiguous range, approaches 1 when free space is scattered
+		*/
+		constexpr const float fragmentation() const
+		{
+			VkDeviceSize freeBytes = reservedBytes - usedBytes;
+			return freeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes);
+		}
+	};
+
+	struct MemoryStats
+	{
+		std::vector<HeapStats> heaps;
+		uint32_t deviceMemoryCount = 0;
+	};
+
+	/**
+	* Power-of-two buddy allocator over one VkDeviceMemory block
+	*/
+	struct BuddyBlock
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		void* mapped = nullptr;
+		VkDeviceSize size = 0;
+		VkDeviceSize usedBytes = 0;
+		uint32_t memoryTypeIndex = 0;
+		uint32_t maxOrder = 0;
+		uint32_t allocationCount = 0;
+		bool linear = true;
+
+		std::vector<std::set<VkDeviceSize>> freeLists;
+
+		static constexpr VkDeviceSize minSize = 256;
+
+		void init(uint32_t order);
+		std::optional<VkDeviceSize> allocate(uint32_t order);
+		void free(VkDeviceSize offset, uint32_t order);
+		VkDeviceSize largestFreeRange() const;
+	};
+
+	/**
+	* Engine owned device memory allocator
+	* long-lived resources are sub-allocated from large per memory-type blocks with a buddy allocator
+	*/
+	class MemoryAllocator
+	{
+	public:
+		MemoryAllocator() = default;
+		~MemoryAllocator() = default;
+
+		MemoryAllocator(const MemoryAllocator&) = delete;
+		MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+		void init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize);
+		void destroy();
+
+		Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0, bool linear = true);
+		void free(Allocation& allocation);
+
+		VkBuffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, Allocation& allocation);
+		void destroyBuffer(VkBuffer buffer, Allocation& allocation);
+		VkImage createImage(const VkImageCreateInfo& createInfo, VkMemoryPropertyFlags required, Allocation& allocation);
+		void destroyImage(VkImage image, Allocation& allocation);
+
+		uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred = 0) const;
+
+		MemoryStats getStats();
+		void logStats();
+
+		constexpr const VkDevice getDevice() const { return _device; }
+		constexpr const VkPhysicalDeviceLimits& getLimits() const { return _limits; }
+		constexpr const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const { return _memoryProperties; }
+
+	protected:
+
+	private:
+		VkDevice _device = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties _memoryProperties{};
+		VkPhysicalDeviceLimits _limits{};
+		VkDeviceSize _blockSize = 0;
+		uint32_t _deviceMemoryCount = 0;
+
+		std::vector<std::unique_ptr<BuddyBlock>> _blocks;
+		std::vector<Allocation> _dedicatedAllocations;
+
+		std::mutex _mutex;
+
+		VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped);
+		void freeDeviceMemory(VkDeviceMemory memory);
+		Allocation allocateDedicated(VkDeviceSize size, uint32_t memoryTypeIndex);
+	};
+
+	/**
+	* Bump allocator over a persistently mapped buffer, reset wholesale
+	*/
+	class LinearPool
+	{
+	public:
+		void init(MemoryAllocator& allocator, VkDeviceSize capacity, VkBufferUsageFlags usage, VkMemoryPropertyFlags required);
+		void destroy(MemoryAllocator& allocator);
+
+		std::optional<BufferRange> allocate(VkDeviceSize size, VkDeviceSize alignment);
+		void reset() { _head = 0; }
+
+		constexpr const VkBuffer getBuffer() const { return _buffer; }
+		constexpr const VkDeviceSize getCapacity() const { return _capacity; }
+		constexpr const VkDeviceSize getUsedBytes() const { return _head; }
+
+	protected:
+
+	private:
+		VkBuffer _buffer = VK_NULL_HANDLE;
+		Allocation _allocation;
+		VkDeviceSize _capacity = 0;
+		VkDeviceSize _head = 0;
+	};
+
+	/**
+	* Ring allocator over a persistently mapped buffer, space is reclaimed per frame in flight
+	*/
+	class RingPool
+	{
+	public:
+		void init(MemoryAllocator& allocator, VkDeviceSize capacity, VkBufferUsageFlags usage, VkMemoryPropertyFlags required, uint32_t framesInFlight);
+		void destroy(MemoryAllocator& allocator);
+
+		void beginFrame(uint32_t frameIndex);
+		std::optional<BufferRange> allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+		constexpr const VkBuffer getBuffer() const { return _buffer; }
+		constexpr const VkDeviceSize getCapacity() const { return _capacity; }
+		constexpr const VkDeviceSize getUsedBytes() const { return _usedBytes; }
+
+	protected:
+
+	private:
+		VkBuffer _buffer = VK_NULL_HANDLE;
+		Allocation _allocation;
+		VkDeviceSize _capacity = 0;
+		VkDeviceSize _head = 0;
+		VkDeviceSize _usedBytes = 0;
+		uint32_t _frameIndex = 0;
+		std::vector<VkDeviceSize> _frameBytes;
+	};
+
+	/**
+	* Linear pool per frame in flight for data written once per frame, persistently mapped
+	* offsets are aligned for binding as uniform or storage buffer ranges, a frame's pool is reset wholesale when its slot comes around again
+	*/
+	class FrameAllocator
+	{
+	public:
+		void init(MemoryAllocator& allocator, VkDeviceSize capacity, uint32_t framesInFlight);
+		void destroy(MemoryAllocator& allocator);
+
+		void beginFrame(uint32_t frameIndex);
+		std::optional<BufferRange> allocate(VkDeviceSize size, VkDeviceSize alignment = 1);
+
+		VkBuffer getBuffer(uint32_t frameIndex) const { return _pools[frameIndex].getBuffer(); }
+		VkDeviceSize getUsedBytes() const { return _pools[_frameIndex].getUsedBytes(); }
+		constexpr const VkDeviceSize getCapacity() const { return _capacity; }
+		constexpr const VkDeviceSize getAlignment() const { return _alignment; }
+		constexpr const uint32_t getFrameIndex() const { return _frameIndex; }
+
+	protected:
+
+	private:
+		std::vector<LinearPool> _pools;
+		VkDeviceSize _capacity = 0;
+		VkDeviceSize _alignment = 1;
+		uint32_t _frameIndex = 0;
+	};
+}
+
+#endif // !_ENGINE_MEMORY_ALLOCATOR_HEADER_
@@ -0,0 +1,197 @@
+#include "FrameStats.h"
+
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* store timing of a presented frame, the sample it overwrites leaves the histograms
+	*/
+	void FrameStats::push(const FrameTiming& timing)
+	{
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		std::array<std::atomic<float>, _metricCount>& sample = _samples[head % capacity];
+
+		const double values[_metricCount] = { timing.cpu, timing.gpu, timing.acquire, timing.present };
+		for (size_t metric = 0; metric < _metricCount; metric++)
+		{
+			if (head >= capacity)
+			{
+				float old = sample[metric].load(std::memory_order_relaxed);
+				if (old >= 0.0f)
+				{
+					_histograms[metric][toBucket(old)]--;
+				}
+			}
+
+			float value = static_cast<float>(values[metric]);
+			if (value >= 0.0f)
+			{
+				_histograms[metric][toBucket(value)]++;
+			}
+			sample[metric].store(value, std::memory_order_relaxed);
+		}
+
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	/**
+	* timing of the last pushed frame, safe to call from any thread
+	*/
+	FrameTiming FrameStats::getLatest() const
+	{
+		uint64_t head = _head.load(std::memory_order_acquire);
+		if (head == 0)
+		{
+			return FrameTiming{};
+		}
+
+		const std::array<std::atomic<float>, _metricCount>& sample = _samples[(head - 1) % capacity];
+
+		return FrameTiming{
+			.cpu = sample[static_cast<size_t>(FrameMetric::Cpu)].load(std::memory_order_relaxed),
+			.gpu = sample[static_cast<size_t>(FrameMetric::Gpu)].load(std::memory_order_relaxed),
+			.acquire = sample[static_cast<size_t>(FrameMetric::Acquire)].load(std::memory_order_relaxed),
+			.present = sample[static_cast<size_t>(FrameMetric::Present)].load(std::memory_order_relaxed),
+		};
+	}
+
+	/**
+	* percentiles of the frames in the ring, reported as bucket upper bounds and clamped to the exact maximum
+	*/
+	FrameMetricSummary FrameStats::summarize(FrameMetric metric) const
+	{
+		size_t index = static_cast<size_t>(metric);
+		const std::array<uint32_t, bucketCount + 1>& histogram = _histograms[index];
+
+		FrameMetricSummary summary;
+
+		uint64_t count = std::min<uint64_t>(_head.load(std::memory_order_relaxed), capacity);
+		for (uint64_t i = 0; i < count; i++)
+		{
+			float value = _samples[i][index].load(std::memory_order_relaxed);
+			if (value >= 0.0f)
+			{
+				summary.max = std::max(summary.max, static_cast<double>(value));
+				summary.samples++;
+			}
+		}
+
+		if (summary.samples == 0)
+		{
+			return summary;
+		}
+
+		const double percentiles[3] = { 0.50, 0.95, 0.99 };
+		double* results[3] = { &summary.p50, &summary.p95, &summary.p99 };
+
+		uint64_t cumulative = 0;
+		size_t next = 0;
+		for (uint32_t bucket = 0; bucket <= bucketCount && next < 3; bucket++)
+		{
+			cumulative += histogram[bucket];
+
+			while (next < 3 && cumulative >= static_cast<uint64_t>(std::ceil(percentiles[next] * summary.samples)))
+			{
+				*results[next] = std::min((bucket + 1) * bucketWidth, summary.max);
+				next++;
+			}
+		}
+
+		return summary;
+	}
+
+	/**
+	* log percentiles of every metric
+	*/
+	void FrameStats::logSummary() const
+	{
+		for (size_t metric = 0; metric < _metricCount; metric++)
+		{
+			FrameMetricSummary summary = summarize(static_cast<FrameMetric>(metric));
+			spdlog::info(std::format("frame stats {:<8} p50={:.2f}ms, p95={:.2f}ms, p99={:.2f}ms, max={:.2f}ms, samples={}",
+				getMetricName(static_cast<FrameMetric>(metric)), summary.p50, summary.p95, summary.p99, summary.max, summary.samples));
+		}
+	}
+
+	/**
+	* write the frames in the ring to path and their percentiles next to it as <name>_summary.csv
+	*/
+	void FrameStats::writeCsv(const std::string_view path) const
+	{
+		std::ofstream file(path.data(), std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", path));
+		}
+
+		file << "frame,cpu_ms,gpu_ms,acquire_ms,present_ms\n";
+
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		uint64_t first = head > capacity ? head - capacity : 0;
+		for (uint64_t frame = first; frame < head; frame++)
+		{
+			file << frame;
+			for (size_t metric = 0; metric < _metricCount; metric++)
+			{
+				/* Unknown values, e.g. GPU time without timestamp support, are left empty */
+				float value = _samples[frame % capacity][metric].load(std::memory_order_relaxed);
+				file << (value >= 0.0f ? std::format(",{:.4f}", value) : std::string(","));
+			}
+			file << "\n";
+		}
+
+		std::filesystem::path summaryPath(path);
+		summaryPath.replace_filename(std::format("{}_summary{}", summaryPath.stem().string(), summaryPath.extension().string()));
+
+		std::ofstream summaryFile(summaryPath, std::ios::trunc);
+		if (!summaryFile.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", summaryPath.string()));
+		}
+
+		summaryFile << "metric,p50_ms,p95_ms,p99_ms,max_ms,samples\n";
+		for (size_t metric = 0; metric < _metricCount; metric++)
+		{
+			FrameMetricSummary summary = summarize(static_cast<FrameMetric>(metric));
+			summaryFile << std::format("{},{:.4f},{:.4f},{:.4f},{:.4f},{}\n", getMetricName(static_cast<FrameMetric>(metric)), summary.p50, summary.p95, summary.p99, summary.max, summary.samples);
+		}
+
+		spdlog::info(std::format("wrote frame stats, path={}, frames={}", path, head - first));
+	}
+
+	/**
+	* histogram bucket of a value in milliseconds
+	*/
+	uint32_t FrameStats::toBucket(float value)
+	{
+		return static_cast<uint32_t>(std::min(value / bucketWidth, static_cast<double>(bucketCount)));
+	}
+
+	/**
+	* metric name used in logs and CSV
+	*/
+	const char* FrameStats::getMetricName(FrameMetric metric)
+	{
+		switch (metric)
+		{
+		case FrameMetric::Cpu:
+			return "cpu";
+		case FrameMetric::Gpu:
+			return "gpu";
+		case FrameMetric::Acquire:
+			return "acquire";
+		case FrameMetric::Present:
+			return "present";
+		default:
+			return "unknown";
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef _ENGINE_FRAME_STATS_HEADER_
+#define _ENGINE_FRAME_STATS_HEADER_
+
+#include <array>
+#include <atomic>
+#include <string>
+
+namespace engine
+{
+	/**
+	* Timings of one presented frame in milliseconds, negative when unknown
+	*/
+	struct FrameTiming
+	{
+		double cpu = -1.0;
+		double gpu = -1.0;
+		double acquire = -1.0;
+		double present = -1.0;
+	};
+
+	enum class FrameMetric
+	{
+		Cpu,
+		Gpu,
+		Acquire,
+		Present,
+		Count,
+	};
+
+	/**
+	* Rolling percentiles of one metric
+	*/
+	struct FrameMetricSummary
+	{
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+		uint32_t samples = 0;
+	};
+
+	/**
+	* Always-on frame time statistics over the last frames
+	* the main loop is the only writer, samples live in a fixed ring that other threads can read without locks
+	* percentiles come from fixed-bucket histograms kept in sync with the ring, nothing is allocated per frame
+	* histograms belong to the writer, summaries and dumps have to be taken on the main loop thread
+	*/
+	class FrameStats
+	{
+	public:
+		FrameStats() = default;
+		~FrameStats() = default;
+
+		FrameStats(const FrameStats&) = delete;
+		FrameStats& operator=(const FrameStats&) = delete;
+
+		void push(const FrameTiming& timing);
+		FrameTiming getLatest() const;
+
+		FrameMetricSummary summarize(FrameMetric metric) const;
+		void logSummary() const;
+		void writeCsv(const std::string_view path) const;
+
+		uint64_t getFrameCount() const { return _head.load(std::memory_order_acquire); }
+
+		static constexpr uint32_t capacity = 1024;
+		static constexpr double bucketWidth = 0.1;
+		static constexpr uint32_t bucketCount = 1000;
+
+	protected:
+
+	private:
+		static constexpr size_t _metricCount = static_cast<size_t>(FrameMetric::Count);
+
+		/* Values are stored as relaxed atomics, a reader racing the writer sees a mix of frames but never a torn value */
+		std::array<std::array<std::atomic<float>, _metricCount>, capacity> _samples{};
+		std::atomic<uint64_t> _head = 0;
+
+		/* Last bucket counts every sample beyond bucketCount * bucketWidth */
+		std::array<std::array<uint32_t, bucketCount + 1>, _metricCount> _histograms{};
+
+		static uint32_t toBucket(float value);
+		static const char* getMetricName(FrameMetric metric);
+	};
+}
+
+#endif // !_ENGINE_FRAME_STATS_HEADER_
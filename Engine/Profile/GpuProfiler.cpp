@@ -0,0 +1,309 @@
+#include "GpuProfiler.h"
+
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* create query pool ring, stays disabled when the queue family has no timestamp support
+	*/
+	void GpuProfiler::init(Profiler* profiler, VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, uint32_t slotCount, const std::string_view trackName)
+	{
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+		uint32_t validBits = families[queueFamily].timestampValidBits;
+		if (validBits == 0)
+		{
+			spdlog::info(std::format("queue family does not support timestamps, gpu profiling disabled, track={}, family={}", trackName, queueFamily));
+			return;
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		_device = device;
+		_period = static_cast<double>(properties.limits.timestampPeriod);
+		_validMask = validBits >= 64 ? UINT64_MAX : (uint64_t{ 1 } << validBits) - 1;
+
+		_slots.resize(slotCount);
+		for (Slot& slot : _slots)
+		{
+			VkQueryPoolCreateInfo poolInfo{
+				.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.queryType = VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount = _maxScopes * 2,
+			};
+
+			if (vkCreateQueryPool(_device, &poolInfo, nullptr, &slot.queryPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create timestamp query pool"));
+			}
+			slot.names.reserve(_maxScopes);
+		}
+		_results.resize(_maxScopes * 2);
+		_events.reserve(_maxScopes);
+
+		/* Calibration only matters for lining GPU scopes up with CPU scopes in a trace */
+		if (profiler != nullptr)
+		{
+			calibrate(*profiler, queue, queueFamily);
+
+			_profiler = profiler;
+			_track = profiler->registerTrack(trackName, true);
+		}
+
+		spdlog::debug(std::format("created gpu profiler, track={}, slots={}, period={}ns, validBits={}", trackName, slotCount, _period, validBits));
+	}
+
+	/**
+	* release query pools, the device has to be idle
+	*/
+	void GpuProfiler::destroy()
+	{
+		for (const Slot& slot : _slots)
+		{
+			vkDestroyQueryPool(_device, slot.queryPool, nullptr);
+		}
+		_slots.clear();
+
+		_profiler = nullptr;
+		_device = VK_NULL_HANDLE;
+		_frameTime = -1.0;
+	}
+
+	/**
+	* collect the previous results of slot and reset its queries, has to be recorded outside a render pass
+	* the caller guarantees the slot's previous submission finished, as with per frame fences
+	*/
+	void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t slot)
+	{
+		if (!isEnabled())
+		{
+			return;
+		}
+
+		_currentSlot = slot % static_cast<uint32_t>(_slots.size());
+		Slot& current = _slots[_currentSlot];
+
+		if (current.pending)
+		{
+			resolve(current);
+		}
+
+		vkCmdResetQueryPool(commandBuffer, current.queryPool, 0, _maxScopes * 2);
+		current.names.clear();
+		current.frame = _profiler != nullptr ? _profiler->getFrame() : 0;
+		current.pending = true;
+	}
+
+	/**
+	* write begin timestamp, returns scope to end
+	*/
+	uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name)
+	{
+		if (!isEnabled())
+		{
+			return UINT32_MAX;
+		}
+
+		Slot& slot = _slots[_currentSlot];
+		if (slot.names.size() >= _maxScopes)
+		{
+			return UINT32_MAX;
+		}
+
+		uint32_t scope = static_cast<uint32_t>(slot.names.size());
+		slot.names.push_back(name);
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, slot.queryPool, scope * 2);
+
+		return scope;
+	}
+
+	/**
+	* write end timestamp once all previous commands completed
+	*/
+	void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope)
+	{
+		if (!isEnabled() || scope == UINT32_MAX)
+		{
+			return;
+		}
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _slots[_currentSlot].queryPool, scope * 2 + 1);
+	}
+
+	/**
+	* read back every slot still holding results, the device has to be idle
+	*/
+	void GpuProfiler::collect()
+	{
+		if (!isEnabled())
+		{
+			return;
+		}
+
+		for (Slot& slot : _slots)
+		{
+			if (slot.pending)
+			{
+				resolve(slot);
+			}
+		}
+	}
+
+	/**
+	* estimate the offset between GPU timestamps and the profiler clock with a single timestamp submission
+	* only called during startup, before anything else is submitted to the queue
+	*/
+	void GpuProfiler::calibrate(Profiler& profiler, VkQueue queue, uint32_t queueFamily)
+	{
+		VkCommandPoolCreateInfo poolInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = queueFamily,
+		};
+
+		VkCommandPool commandPool;
+		if (vkCreateCommandPool(_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create calibration command pool"));
+		}
+
+		VkCommandBufferAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+
+		VkCommandBuffer commandBuffer;
+		vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer);
+
+		VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		};
+
+		VkQueryPool queryPool = _slots.front().queryPool;
+
+		vkBeginCommandBuffer(commandBuffer, &beginInfo);
+		vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+		vkEndCommandBuffer(commandBuffer);
+
+		VkFenceCreateInfo fenceInfo{
+			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		};
+
+		VkFence fence;
+		if (vkCreateFence(_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create calibration fence"));
+		}
+
+		VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &commandBuffer,
+		};
+
+		/* The timestamp lands between submit and fence signal, take the midpoint on the CPU side */
+		double before = profiler.now();
+		if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to submit calibration command buffer"));
+		}
+		vkWaitForFences(_device, 1, &fence, VK_TRUE, UINT64_MAX);
+		double after = profiler.now();
+
+		uint64_t timestamp = 0;
+		vkGetQueryPoolResults(_device, queryPool, 0, 1, sizeof(timestamp), &timestamp, sizeof(timestamp), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+		/* Offset has to be zero while converting the calibration timestamp itself */
+		_offset = 0.0;
+		_offset = (before + after) * 0.5 - toMicroseconds(timestamp);
+
+		vkDestroyFence(_device, fence, nullptr);
+		vkDestroyCommandPool(_device, commandPool, nullptr);
+	}
+
+	/**
+	* read finished timestamps of slot, keep the span they cover as frame time and hand them to the profiler
+	*/
+	void GpuProfiler::resolve(Slot& slot)
+	{
+		slot.pending = false;
+
+		uint32_t queryCount = static_cast<uint32_t>(slot.names.size()) * 2;
+		if (queryCount == 0)
+		{
+			return;
+		}
+
+		VkResult result = vkGetQueryPoolResults(_device, slot.queryPool, 0, queryCount, queryCount * sizeof(uint64_t), _results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+		{
+			/* VK_NOT_READY, a scope was begun but never ended or the slot was reused too early */
+			return;
+		}
+
+		double frameBegin = toMicroseconds(_results[0]);
+		double frameEnd = frameBegin;
+
+		_events.clear();
+		for (size_t i = 0; i < slot.names.size(); i++)
+		{
+			double begin = toMicroseconds(_results[i * 2]);
+			double end = toMicroseconds(_results[i * 2 + 1]);
+
+			frameBegin = std::min(frameBegin, begin);
+			frameEnd = std::max(frameEnd, end);
+
+			_events.push_back(ProfileEvent{
+				.name = slot.names[i],
+				.frame = slot.frame,
+				.begin = begin,
+				.duration = end - begin,
+			});
+		}
+
+		_frameTime = (frameEnd - frameBegin) / 1000.0;
+
+		if (_profiler != nullptr)
+		{
+			_profiler->record(_track, _events);
+		}
+	}
+
+	/**
+	* convert timestamp ticks to the profiler clock
+	*/
+	double GpuProfiler::toMicroseconds(uint64_t timestamp) const
+	{
+		return static_cast<double>(timestamp & _validMask) * _period / 1000.0 + _offset;
+	}
+
+	/**
+	* begin GPU scope
+	*/
+	GpuScope::GpuScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+		: _profiler(profiler), _commandBuffer(commandBuffer), _scope(profiler.beginScope(commandBuffer, name))
+	{
+	}
+
+	/**
+	* end GPU scope
+	*/
+	GpuScope::~GpuScope()
+	{
+		_profiler.endScope(_commandBuffer, _scope);
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef _ENGINE_GPU_PROFILER_HEADER_
+#define _ENGINE_GPU_PROFILER_HEADER_
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Profiler.h"
+
+namespace engine
+{
+	/**
+	* Timestamp queries of one queue, written into a ring of query pools
+	* a slot is read back when it is reused, its previous submission has been waited on by then so results never stall
+	* without a profiler only the GPU frame time is kept
+	*/
+	class GpuProfiler
+	{
+	public:
+		GpuProfiler() = default;
+		~GpuProfiler() = default;
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		void init(Profiler* profiler, VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamily, uint32_t slotCount, const std::string_view trackName);
+		void destroy();
+
+		void beginFrame(VkCommandBuffer commandBuffer, uint32_t slot);
+		uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+		void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+		void collect();
+
+		constexpr const bool isEnabled() const { return _device != VK_NULL_HANDLE; }
+		constexpr const double getFrameTime() const { return _frameTime; }
+
+	protected:
+
+	private:
+		struct Slot
+		{
+			VkQueryPool queryPool = VK_NULL_HANDLE;
+			std::vector<const char*> names;
+			uint64_t frame = 0;
+			bool pending = false;
+		};
+
+		Profiler* _profiler = nullptr;
+		VkDevice _device = VK_NULL_HANDLE;
+		uint32_t _track = 0;
+		double _frameTime = -1.0;
+
+		double _period = 0.0;
+		uint64_t _validMask = 0;
+		double _offset = 0.0;
+
+		std::vector<Slot> _slots;
+		uint32_t _currentSlot = 0;
+		std::vector<uint64_t> _results;
+		std::vector<ProfileEvent> _events;
+
+		static constexpr uint32_t _maxScopes = 64;
+
+		void calibrate(Profiler& profiler, VkQueue queue, uint32_t queueFamily);
+		void resolve(Slot& slot);
+		double toMicroseconds(uint64_t timestamp) const;
+	};
+
+	/**
+	* Records the GPU time of the commands recorded during its lifetime
+	*/
+	class GpuScope
+	{
+	public:
+		GpuScope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name);
+		~GpuScope();
+
+		GpuScope(const GpuScope&) = delete;
+		GpuScope& operator=(const GpuScope&) = delete;
+
+	protected:
+
+	private:
+		GpuProfiler& _profiler;
+		VkCommandBuffer _commandBuffer;
+		uint32_t _scope;
+	};
+}
+
+#endif // !_ENGINE_GPU_PROFILER_HEADER_
@@ -0,0 +1,224 @@
+#include "Profiler.h"
+
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		thread_local const Profiler* trackOwner = nullptr;
+		thread_local uint32_t threadTrack = 0;
+	}
+
+	/**
+	* escape a string for a JSON string literal
+	*/
+	std::string escapeJson(const std::string_view text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				escaped.push_back('\\');
+			}
+			escaped.push_back(c);
+		}
+
+		return escaped;
+	}
+
+	/**
+	* start collecting, events older than retainedFrames are dropped
+	*/
+	void Profiler::init(uint32_t retainedFrames)
+	{
+		_epoch = std::chrono::steady_clock::now();
+		_retainedFrames = retainedFrames;
+
+		/* The initializing thread is the main thread */
+		trackOwner = this;
+		threadTrack = registerTrack("main", false);
+
+		_enabled.store(true, std::memory_order_release);
+	}
+
+	/**
+	* advance frame number, called once per frame by the main thread
+	*/
+	void Profiler::beginFrame()
+	{
+		_frame.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	* add a timeline, returns its index
+	*/
+	uint32_t Profiler::registerTrack(const std::string_view name, bool gpu)
+	{
+		std::lock_guard<std::mutex> lock(_tracksMutex);
+
+		_tracks.push_back(std::make_unique<Track>());
+		_tracks.back()->name = name;
+		_tracks.back()->gpu = gpu;
+
+		return static_cast<uint32_t>(_tracks.size() - 1);
+	}
+
+	/**
+	* record CPU scope on the calling thread's track
+	*/
+	void Profiler::record(const char* name, double begin, double end)
+	{
+		uint32_t index = getThreadTrack();
+
+		Track* track;
+		{
+			std::lock_guard<std::mutex> lock(_tracksMutex);
+			track = _tracks[index].get();
+		}
+
+		append(*track, ProfileEvent{
+			.name = name,
+			.frame = getFrame(),
+			.begin = begin,
+			.duration = end - begin,
+		});
+	}
+
+	/**
+	* record resolved GPU scopes on a queue track
+	*/
+	void Profiler::record(uint32_t index, std::span<const ProfileEvent> events)
+	{
+		Track* track;
+		{
+			std::lock_guard<std::mutex> lock(_tracksMutex);
+			track = _tracks[index].get();
+		}
+
+		for (const ProfileEvent& event : events)
+		{
+			append(*track, event);
+		}
+	}
+
+	/**
+	* write the scopes of [firstFrame, lastFrame] as Chrome trace JSON, viewable in chrome://tracing or Perfetto
+	*/
+	void Profiler::exportChromeTrace(const std::string_view path, uint64_t firstFrame, uint64_t lastFrame)
+	{
+		std::ofstream file(path.data(), std::ios::trunc);
+		if (!file.is_open())
+		{
+			throw std::runtime_error(std::format("failed to open file. filename={}", path));
+		}
+
+		/* CPU tracks are threads of process 0, GPU queues threads of process 1 */
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}}";
+
+		size_t eventCount = 0;
+
+		std::lock_guard<std::mutex> tracksLock(_tracksMutex);
+		for (size_t i = 0; i < _tracks.size(); i++)
+		{
+			Track& track = *_tracks[i];
+			uint32_t pid = track.gpu ? 1 : 0;
+
+			file << std::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", pid, i, escapeJson(track.name));
+
+			std::lock_guard<std::mutex> lock(track.mutex);
+			for (const ProfileEvent& event : track.events)
+			{
+				if (event.frame < firstFrame || event.frame > lastFrame)
+				{
+					continue;
+				}
+
+				file << std::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"frame\":{}}}}}",
+					escapeJson(event.name), pid, i, event.begin, event.duration, event.frame);
+				eventCount++;
+			}
+		}
+
+		file << "\n]}\n";
+
+		spdlog::info(std::format("exported chrome trace, path={}, frames={}-{}, events={}", path, firstFrame, lastFrame, eventCount));
+	}
+
+	/**
+	* microseconds since the profiler epoch
+	*/
+	double Profiler::now() const
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - _epoch).count();
+	}
+
+	/**
+	* track of the calling thread, registered on its first event
+	*/
+	uint32_t Profiler::getThreadTrack()
+	{
+		if (trackOwner != this)
+		{
+			size_t trackCount;
+			{
+				std::lock_guard<std::mutex> lock(_tracksMutex);
+				trackCount = _tracks.size();
+			}
+
+			threadTrack = registerTrack(std::format("thread {}", trackCount), false);
+			trackOwner = this;
+		}
+
+		return threadTrack;
+	}
+
+	/**
+	* append event and drop the ones that left the retained frame window
+	*/
+	void Profiler::append(Track& track, const ProfileEvent& event)
+	{
+		uint64_t frame = getFrame();
+
+		std::lock_guard<std::mutex> lock(track.mutex);
+		while (!track.events.empty() && track.events.front().frame + _retainedFrames < frame)
+		{
+			track.events.pop_front();
+		}
+		track.events.push_back(event);
+	}
+
+	/**
+	* start CPU scope
+	*/
+	CpuScope::CpuScope(const char* name)
+		: _name(name)
+	{
+		Profiler* profiler = ServiceRegistry::tryGet<Profiler>();
+		if (profiler != nullptr && profiler->isEnabled())
+		{
+			_profiler = profiler;
+			_begin = profiler->now();
+		}
+	}
+
+	/**
+	* end CPU scope
+	*/
+	CpuScope::~CpuScope()
+	{
+		if (_profiler != nullptr)
+		{
+			_profiler->record(_name, _begin, _profiler->now());
+		}
+	}
+}
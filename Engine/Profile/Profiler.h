@@ -0,0 +1,94 @@
+#ifndef _ENGINE_PROFILER_HEADER_
+#define _ENGINE_PROFILER_HEADER_
+
+#include <span>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Prototype/ServiceRegistry.hpp"
+
+namespace engine
+{
+	/**
+	* Timed scope, times are microseconds since the profiler epoch
+	*/
+	struct ProfileEvent
+	{
+		const char* name;
+		uint64_t frame;
+		double begin;
+		double duration;
+	};
+
+	std::string escapeJson(const std::string_view text);
+
+	/**
+	* Collects CPU and GPU scopes of the last frames into one timeline per thread or queue
+	* every thread appends to its own track, tracks are only shared with the exporter
+	*/
+	class Profiler : public Service<Profiler>
+	{
+	public:
+		void init(uint32_t retainedFrames);
+		void beginFrame();
+
+		uint32_t registerTrack(const std::string_view name, bool gpu);
+		void record(const char* name, double begin, double end);
+		void record(uint32_t track, std::span<const ProfileEvent> events);
+
+		void exportChromeTrace(const std::string_view path, uint64_t firstFrame, uint64_t lastFrame);
+
+		double now() const;
+		uint64_t getFrame() const { return _frame.load(std::memory_order_relaxed); }
+		bool isEnabled() const { return _enabled.load(std::memory_order_acquire); }
+
+	protected:
+
+	private:
+		struct Track
+		{
+			std::string name;
+			bool gpu = false;
+			std::mutex mutex;
+			std::deque<ProfileEvent> events;
+		};
+
+		std::atomic<bool> _enabled = false;
+		std::chrono::steady_clock::time_point _epoch;
+		std::atomic<uint64_t> _frame = 0;
+		uint32_t _retainedFrames = 0;
+
+		std::mutex _tracksMutex;
+		std::vector<std::unique_ptr<Track>> _tracks;
+
+		uint32_t getThreadTrack();
+		void append(Track& track, const ProfileEvent& event);
+	};
+
+	/**
+	* Records the lifetime of a CPU scope when the profiler is enabled
+	*/
+	class CpuScope
+	{
+	public:
+		explicit CpuScope(const char* name);
+		~CpuScope();
+
+		CpuScope(const CpuScope&) = delete;
+		CpuScope& operator=(const CpuScope&) = delete;
+
+	protected:
+
+	private:
+		Profiler* _profiler = nullptr;
+		const char* _name;
+		double _begin = 0.0;
+	};
+}
+
+#endif // !_ENGINE_PROFILER_HEADER_
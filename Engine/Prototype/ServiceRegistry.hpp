@@ -0,0 +1,110 @@
+#ifndef _ENGINE_SERVICE_REGISTRY_HEADER_
+#define _ENGINE_SERVICE_REGISTRY_HEADER_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <format>
+#include <cassert>
+#include <typeinfo>
+#include <stdexcept>
+
+/**
+* Explicitly constructed services, torn down in reverse registration order
+* lookups are a single acquire load, registration and teardown are serialized by a mutex
+*/
+class ServiceRegistry
+{
+public:
+	/**
+	* construct and publish service, registering a type twice is an error
+	*/
+	template <typename T, typename... Args>
+	static T& registerService(Args&&... args)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (Slot<T>::instance.load(std::memory_order_relaxed) != nullptr)
+		{
+			throw std::runtime_error(std::format("service already registered, type={}", typeid(T).name()));
+		}
+
+		T* service = new T(std::forward<Args>(args)...);
+		_teardown.push_back(&destroyService<T>);
+		Slot<T>::instance.store(service, std::memory_order_release);
+
+		return *service;
+	}
+
+	/**
+	* registered service, must only be called between registration and shutdown
+	*/
+	template <typename T>
+	static T& get()
+	{
+		T* service = Slot<T>::instance.load(std::memory_order_acquire);
+		assert(service != nullptr && "service not registered");
+		return *service;
+	}
+
+	/**
+	* registered service or nullptr
+	*/
+	template <typename T>
+	static T* tryGet()
+	{
+		return Slot<T>::instance.load(std::memory_order_acquire);
+	}
+
+	/**
+	* destroy services, last registered first
+	*/
+	static void shutdown()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		while (!_teardown.empty())
+		{
+			void (*destroy)() = _teardown.back();
+			_teardown.pop_back();
+			destroy();
+		}
+	}
+
+protected:
+
+private:
+	template <typename T>
+	struct Slot
+	{
+		static inline std::atomic<T*> instance = nullptr;
+	};
+
+	static inline std::mutex _mutex;
+	static inline std::vector<void (*)()> _teardown;
+
+	template <typename T>
+	static void destroyService()
+	{
+		/* Unpublish first, so late lookups see nullptr instead of a dying object */
+		delete Slot<T>::instance.exchange(nullptr, std::memory_order_acq_rel);
+	}
+};
+
+/**
+* Inherit this class to access a registered service through T::getInstance
+*/
+template <typename T>
+class Service
+{
+public:
+	static T* getInstance() { return &ServiceRegistry::get<T>(); }
+
+protected:
+	Service() = default;
+	~Service() = default;
+
+private:
+};
+
+#endif // !_ENGINE_SERVICE_REGISTRY_HEADER_
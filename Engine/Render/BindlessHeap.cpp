@@ -0,0 +1,272 @@
+#include "BindlessHeap.h"
+
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		constexpr std::array<VkDescriptorType, 3> descriptorTypes = {
+			VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+			VK_DESCRIPTOR_TYPE_SAMPLER,
+			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		};
+
+		constexpr const char* getTypeName(BindlessType type)
+		{
+			switch (type)
+			{
+			case BindlessType::Texture:
+				return "texture";
+			case BindlessType::Sampler:
+				return "sampler";
+			case BindlessType::Buffer:
+				return "buffer";
+			default:
+				return "unknown";
+			}
+		}
+	}
+
+	/**
+	* create the global set sized to the device's update-after-bind limits
+	*/
+	void BindlessHeap::init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight)
+	{
+		_device = device;
+		_retired.assign(framesInFlight, {});
+		_frameIndex = 0;
+
+		VkPhysicalDeviceVulkan12Properties vulkan12Properties{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+		};
+
+		VkPhysicalDeviceProperties2 properties{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &vulkan12Properties,
+		};
+
+		vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+		/* Every array is visible to all graphics and compute stages, so the per stage limit applies as well */
+		_slots[static_cast<uint32_t>(BindlessType::Texture)].capacity = std::min({ maxTextures,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+		_slots[static_cast<uint32_t>(BindlessType::Sampler)].capacity = std::min({ maxSamplers,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers });
+		_slots[static_cast<uint32_t>(BindlessType::Buffer)].capacity = std::min({ maxBuffers,
+			vulkan12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers, vulkan12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings;
+		std::array<VkDescriptorBindingFlags, 3> bindingFlags;
+		std::array<VkDescriptorPoolSize, 3> poolSizes;
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding{
+				.binding = i,
+				.descriptorType = descriptorTypes[i],
+				.descriptorCount = _slots[i].capacity,
+				.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT,
+			};
+
+			/* Unused entries stay unwritten, entries are written while command buffers using other entries are pending */
+			bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+			poolSizes[i] = VkDescriptorPoolSize{
+				.type = descriptorTypes[i],
+				.descriptorCount = _slots[i].capacity,
+			};
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+			.bindingCount = static_cast<uint32_t>(bindingFlags.size()),
+			.pBindingFlags = bindingFlags.data(),
+		};
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.pNext = &bindingFlagsInfo,
+			.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+			.bindingCount = static_cast<uint32_t>(bindings.size()),
+			.pBindings = bindings.data(),
+		};
+
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_setLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create bindless descriptor set layout"));
+		}
+
+		VkDescriptorPoolCreateInfo poolInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+			.maxSets = 1,
+			.poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+			.pPoolSizes = poolSizes.data(),
+		};
+
+		if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_descriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create bindless descriptor pool"));
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = _descriptorPool,
+			.descriptorSetCount = 1,
+			.pSetLayouts = &_setLayout,
+		};
+
+		if (vkAllocateDescriptorSets(_device, &allocInfo, &_descriptorSet) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to allocate bindless descriptor set"));
+		}
+
+		spdlog::debug(std::format("created bindless heap, textures={}, samplers={}, buffers={}",
+			getCapacity(BindlessType::Texture), getCapacity(BindlessType::Sampler), getCapacity(BindlessType::Buffer)));
+	}
+
+	/**
+	* destroy the global set, the device has to be idle
+	*/
+	void BindlessHeap::destroy()
+	{
+		if (_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+		_setLayout = VK_NULL_HANDLE;
+		_descriptorSet = VK_NULL_HANDLE;
+		_device = VK_NULL_HANDLE;
+
+		_slots = {};
+		_retired.clear();
+	}
+
+	/**
+	* write a sampled image into the texture array, returns its index
+	*/
+	uint32_t BindlessHeap::registerTexture(VkImageView imageView, VkImageLayout layout)
+	{
+		VkDescriptorImageInfo imageInfo{
+			.sampler = VK_NULL_HANDLE,
+			.imageView = imageView,
+			.imageLayout = layout,
+		};
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		uint32_t index = allocateIndex(BindlessType::Texture);
+		write(BindlessType::Texture, index, &imageInfo, nullptr);
+
+		return index;
+	}
+
+	/**
+	* write a sampler into the sampler array, returns its index
+	*/
+	uint32_t BindlessHeap::registerSampler(VkSampler sampler)
+	{
+		VkDescriptorImageInfo imageInfo{
+			.sampler = sampler,
+		};
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		uint32_t index = allocateIndex(BindlessType::Sampler);
+		write(BindlessType::Sampler, index, &imageInfo, nullptr);
+
+		return index;
+	}
+
+	/**
+	* write a storage buffer range into the buffer array, returns its index
+	*/
+	uint32_t BindlessHeap::registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		VkDescriptorBufferInfo bufferInfo{
+			.buffer = buffer,
+			.offset = offset,
+			.range = range,
+		};
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		uint32_t index = allocateIndex(BindlessType::Buffer);
+		write(BindlessType::Buffer, index, nullptr, &bufferInfo);
+
+		return index;
+	}
+
+	/**
+	* give an index back, it is reused once the frames recorded until now have finished
+	*/
+	void BindlessHeap::release(BindlessType type, uint32_t index)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_retired[_frameIndex].push_back(RetiredIndex{
+			.type = type,
+			.index = index,
+		});
+	}
+
+	/**
+	* recycle the indices retired the last time frameIndex was recorded, call after waiting for the frame's fence
+	*/
+	void BindlessHeap::beginFrame(uint32_t frameIndex)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_frameIndex = frameIndex;
+
+		for (const RetiredIndex& retired : _retired[frameIndex])
+		{
+			_slots[static_cast<uint32_t>(retired.type)].free.push_back(retired.index);
+		}
+		_retired[frameIndex].clear();
+	}
+
+	/**
+	* take a free index of a binding, fresh indices are handed out in order
+	*/
+	uint32_t BindlessHeap::allocateIndex(BindlessType type)
+	{
+		Slots& slots = _slots[static_cast<uint32_t>(type)];
+
+		if (!slots.free.empty())
+		{
+			uint32_t index = slots.free.back();
+			slots.free.pop_back();
+			return index;
+		}
+
+		if (slots.next >= slots.capacity)
+		{
+			throw std::runtime_error(std::format("bindless heap is full, type={}, capacity={}", getTypeName(type), slots.capacity));
+		}
+
+		return slots.next++;
+	}
+
+	/**
+	* update one array element, the caller holds the mutex
+	*/
+	void BindlessHeap::write(BindlessType type, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+	{
+		VkWriteDescriptorSet write{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = _descriptorSet,
+			.dstBinding = static_cast<uint32_t>(type),
+			.dstArrayElement = index,
+			.descriptorCount = 1,
+			.descriptorType = descriptorTypes[static_cast<uint32_t>(type)],
+			.pImageInfo = imageInfo,
+			.pBufferInfo = bufferInfo,
+		};
+
+		vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+	}
+}
@@ -0,0 +1,94 @@
+#ifndef _ENGINE_BINDLESS_HEAP_HEADER_
+#define _ENGINE_BINDLESS_HEAP_HEADER_
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace engine
+{
+	/**
+	* Resource kinds of the bindless set, the value is the binding the kind lives at
+	*/
+	enum class BindlessType : uint32_t
+	{
+		Texture = 0,
+		Sampler = 1,
+		Buffer = 2,
+	};
+
+	/**
+	* One global update-after-bind descriptor set holding every texture, sampler and storage buffer
+	* shaders index the arrays with indices passed in push constants, so draws never allocate or bind sets
+	* released indices are recycled once every frame in flight that could still read them has finished
+	*/
+	class BindlessHeap
+	{
+	public:
+		BindlessHeap() = default;
+		~BindlessHeap() = default;
+
+		BindlessHeap(const BindlessHeap&) = delete;
+		BindlessHeap& operator=(const BindlessHeap&) = delete;
+
+		void init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight);
+		void destroy();
+
+		uint32_t registerTexture(VkImageView imageView, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t registerSampler(VkSampler sampler);
+		uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		void release(BindlessType type, uint32_t index);
+
+		void beginFrame(uint32_t frameIndex);
+
+		constexpr const VkDescriptorSetLayout getSetLayout() const { return _setLayout; }
+		constexpr const VkDescriptorSet getDescriptorSet() const { return _descriptorSet; }
+		constexpr const uint32_t getCapacity(BindlessType type) const { return _slots[static_cast<uint32_t>(type)].capacity; }
+
+		/* Upper bounds of the arrays, lowered to the device's update-after-bind limits */
+		static constexpr uint32_t maxTextures = 16384;
+		static constexpr uint32_t maxSamplers = 256;
+		static constexpr uint32_t maxBuffers = 16384;
+
+	protected:
+
+	private:
+		/**
+		* Index allocator of one binding
+		*/
+		struct Slots
+		{
+			uint32_t capacity = 0;
+			uint32_t next = 0;
+			std::vector<uint32_t> free;
+		};
+
+		/**
+		* Index released while frameIndex was being recorded
+		*/
+		struct RetiredIndex
+		{
+			BindlessType type;
+			uint32_t index;
+		};
+
+		VkDevice _device = VK_NULL_HANDLE;
+		VkDescriptorSetLayout _setLayout = VK_NULL_HANDLE;
+		VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+
+		std::array<Slots, 3> _slots;
+		std::vector<std::vector<RetiredIndex>> _retired;
+		uint32_t _frameIndex = 0;
+
+		std::mutex _mutex;
+
+		uint32_t allocateIndex(BindlessType type);
+		void write(BindlessType type, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo);
+	};
+}
+
+#endif // !_ENGINE_BINDLESS_HEAP_HEADER_
@@ -0,0 +1,345 @@
+#include "FrustumCulling.h"
+
+#include <bit>
+#include <cmath>
+#include <array>
+#include <format>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ENGINE_CULL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ENGINE_TARGET_AVX2
+#else
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif // _MSC_VER
+#endif // __x86_64__ || _M_X64
+
+namespace engine
+{
+	namespace
+	{
+		/**
+		* reference kernel, also culls the tails the vector kernels leave
+		*/
+		size_t cullScalar(const Frustum& frustum, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible)
+		{
+			size_t count = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				bool inside = true;
+				for (const Plane& plane : frustum.planes)
+				{
+					float distance = plane.normal[0] * bounds.centerX[i] + plane.normal[1] * bounds.centerY[i] + plane.normal[2] * bounds.centerZ[i] + plane.distance;
+					inside &= distance >= -bounds.radius[i];
+				}
+
+				visible[count] = static_cast<uint32_t>(i);
+				count += inside ? 1 : 0;
+			}
+
+			return count;
+		}
+
+#ifdef ENGINE_CULL_X86
+		/**
+		* four spheres per iteration, visible lanes are written without branches
+		*/
+		size_t cullSse(const Frustum& frustum, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible)
+		{
+			__m128 planes[6][4];
+			for (size_t p = 0; p < 6; p++)
+			{
+				planes[p][0] = _mm_set1_ps(frustum.planes[p].normal[0]);
+				planes[p][1] = _mm_set1_ps(frustum.planes[p].normal[1]);
+				planes[p][2] = _mm_set1_ps(frustum.planes[p].normal[2]);
+				planes[p][3] = _mm_set1_ps(frustum.planes[p].distance);
+			}
+
+			size_t count = 0;
+			size_t i = first;
+			for (; i + 4 <= last; i += 4)
+			{
+				__m128 x = _mm_loadu_ps(bounds.centerX + i);
+				__m128 y = _mm_loadu_ps(bounds.centerY + i);
+				__m128 z = _mm_loadu_ps(bounds.centerZ + i);
+				__m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(bounds.radius + i));
+
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m128 distance = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(x, planes[p][0]), _mm_mul_ps(y, planes[p][1])),
+						_mm_add_ps(_mm_mul_ps(z, planes[p][2]), planes[p][3]));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+				}
+
+				int mask = _mm_movemask_ps(inside);
+				for (int lane = 0; lane < 4; lane++)
+				{
+					visible[count] = static_cast<uint32_t>(i + lane);
+					count += (mask >> lane) & 1;
+				}
+			}
+
+			return count + cullScalar(frustum, bounds, i, last, visible + count);
+		}
+
+		/**
+		* lane permutation moving the set lanes of every 8-bit mask to the front
+		*/
+		constexpr std::array<std::array<uint32_t, 8>, 256> makeCompactTable()
+		{
+			std::array<std::array<uint32_t, 8>, 256> table{};
+			for (uint32_t mask = 0; mask < 256; mask++)
+			{
+				uint32_t count = 0;
+				for (uint32_t lane = 0; lane < 8; lane++)
+				{
+					if (mask & (1u << lane))
+					{
+						table[mask][count++] = lane;
+					}
+				}
+			}
+
+			return table;
+		}
+
+		alignas(32) constexpr std::array<std::array<uint32_t, 8>, 256> compactTable = makeCompactTable();
+
+		/**
+		* eight spheres per iteration with FMA, visible indices are packed with one permute and stored as a whole register
+		*/
+		ENGINE_TARGET_AVX2 size_t cullAvx2(const Frustum& frustum, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible)
+		{
+			__m256 planes[6][4];
+			for (size_t p = 0; p < 6; p++)
+			{
+				planes[p][0] = _mm256_set1_ps(frustum.planes[p].normal[0]);
+				planes[p][1] = _mm256_set1_ps(frustum.planes[p].normal[1]);
+				planes[p][2] = _mm256_set1_ps(frustum.planes[p].normal[2]);
+				planes[p][3] = _mm256_set1_ps(frustum.planes[p].distance);
+			}
+
+			const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+			size_t count = 0;
+			size_t i = first;
+			for (; i + 8 <= last; i += 8)
+			{
+				__m256 x = _mm256_loadu_ps(bounds.centerX + i);
+				__m256 y = _mm256_loadu_ps(bounds.centerY + i);
+				__m256 z = _mm256_loadu_ps(bounds.centerZ + i);
+				__m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(bounds.radius + i));
+
+				__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+				for (size_t p = 0; p < 6; p++)
+				{
+					__m256 distance = _mm256_fmadd_ps(x, planes[p][0], _mm256_fmadd_ps(y, planes[p][1], _mm256_fmadd_ps(z, planes[p][2], planes[p][3])));
+					inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+				}
+
+				uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+				__m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(i)), laneOffsets);
+				__m256i permutation = _mm256_load_si256(reinterpret_cast<const __m256i*>(compactTable[mask].data()));
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + count), _mm256_permutevar8x32_epi32(indices, permutation));
+				count += std::popcount(mask);
+			}
+
+			return count + cullScalar(frustum, bounds, i, last, visible + count);
+		}
+
+		/**
+		* whether the CPU and OS support AVX2 and FMA
+		*/
+		bool hasAvx2()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+
+			__cpuid(info, 1);
+			bool fma = (info[2] & (1 << 12)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			{
+				return false;
+			}
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif // _MSC_VER
+		}
+#endif // ENGINE_CULL_X86
+	}
+
+	/**
+	* extract the frustum planes of a column-major view-projection matrix with Vulkan's [0, 1] depth range
+	*/
+	Frustum Frustum::fromViewProjection(const float (&matrix)[16])
+	{
+		auto element = [&matrix](int row, int column) { return matrix[column * 4 + row]; };
+
+		/* Left, right, bottom, top from -w <= x, y <= w, near and far from 0 <= z <= w */
+		float planes[6][4];
+		for (int column = 0; column < 4; column++)
+		{
+			planes[0][column] = element(3, column) + element(0, column);
+			planes[1][column] = element(3, column) - element(0, column);
+			planes[2][column] = element(3, column) + element(1, column);
+			planes[3][column] = element(3, column) - element(1, column);
+			planes[4][column] = element(2, column);
+			planes[5][column] = element(3, column) - element(2, column);
+		}
+
+		Frustum frustum;
+		for (size_t p = 0; p < 6; p++)
+		{
+			float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+			float scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+			frustum.planes[p] = Plane{
+				.normal = { planes[p][0] * scale, planes[p][1] * scale, planes[p][2] * scale },
+				.distance = planes[p][3] * scale,
+			};
+		}
+
+		return frustum;
+	}
+
+	/**
+	* widest kernel the CPU supports
+	*/
+	CullKernel detectCullKernel()
+	{
+#ifdef ENGINE_CULL_X86
+		static const CullKernel kernel = hasAvx2() ? CullKernel::Avx2 : CullKernel::Sse;
+		return kernel;
+#else
+		return CullKernel::Scalar;
+#endif // ENGINE_CULL_X86
+	}
+
+	/**
+	* kernel of a config value, auto and avx2 pick the widest supported kernel
+	*/
+	CullKernel parseCullKernel(const std::string_view name)
+	{
+		if (name == "scalar")
+		{
+			return CullKernel::Scalar;
+		}
+		if (name == "sse")
+		{
+			return CullKernel::Sse;
+		}
+		if (name == "auto" || name == "avx2")
+		{
+			return CullKernel::Avx2;
+		}
+
+		throw std::runtime_error(std::format("unknown cull kernel, name={}", name));
+	}
+
+	/**
+	* kernel name used in logs and benchmark output
+	*/
+	const char* getCullKernelName(CullKernel kernel)
+	{
+		switch (kernel)
+		{
+		case CullKernel::Scalar:
+			return "scalar";
+		case CullKernel::Sse:
+			return "sse";
+		case CullKernel::Avx2:
+			return "avx2";
+		default:
+			return "unknown";
+		}
+	}
+
+	/**
+	* write indices of the spheres in [first, last) touching the frustum to visible and return their count
+	* visible needs room for last - first + FrustumCuller::storePadding indices, kernels the CPU lacks fall back to narrower ones
+	*/
+	size_t cullSpheres(CullKernel kernel, const Frustum& frustum, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible)
+	{
+#ifdef ENGINE_CULL_X86
+		if (kernel == CullKernel::Avx2 && detectCullKernel() == CullKernel::Avx2)
+		{
+			return cullAvx2(frustum, bounds, first, last, visible);
+		}
+		if (kernel != CullKernel::Scalar)
+		{
+			return cullSse(frustum, bounds, first, last, visible);
+		}
+#endif // ENGINE_CULL_X86
+
+		return cullScalar(frustum, bounds, first, last, visible);
+	}
+
+	/**
+	* use kernel, or the widest supported one when the CPU lacks it, jobSystem may be null to cull on the calling thread
+	*/
+	void FrustumCuller::init(JobSystem* jobSystem, CullKernel kernel)
+	{
+		_jobSystem = jobSystem;
+		_kernel = std::min(kernel, detectCullKernel());
+	}
+
+	/**
+	* cull every sphere, the returned indices stay valid until the next call
+	*/
+	std::span<const uint32_t> FrustumCuller::cull(const Frustum& frustum, const SphereBounds& bounds)
+	{
+		size_t chunkCount = (bounds.count + chunkSize - 1) / chunkSize;
+		size_t stride = chunkSize + storePadding;
+
+		_visible.resize(chunkCount * stride);
+		_chunkCounts.resize(chunkCount);
+
+		auto cullChunks = [this, &frustum, &bounds, stride](size_t firstChunk, size_t lastChunk)
+		{
+			for (size_t chunk = firstChunk; chunk < lastChunk; chunk++)
+			{
+				size_t first = chunk * chunkSize;
+				size_t last = std::min(first + chunkSize, bounds.count);
+				_chunkCounts[chunk] = cullSpheres(_kernel, frustum, bounds, first, last, _visible.data() + chunk * stride);
+			}
+		};
+
+		if (_jobSystem != nullptr)
+		{
+			_jobSystem->parallelFor(0, chunkCount, 1, cullChunks);
+		}
+		else
+		{
+			cullChunks(0, chunkCount);
+		}
+
+		/* Slices are moved down in order, the first one is already in place */
+		size_t visibleCount = chunkCount > 0 ? _chunkCounts[0] : 0;
+		for (size_t chunk = 1; chunk < chunkCount; chunk++)
+		{
+			std::memmove(_visible.data() + visibleCount, _visible.data() + chunk * stride, _chunkCounts[chunk] * sizeof(uint32_t));
+			visibleCount += _chunkCounts[chunk];
+		}
+
+		return std::span<const uint32_t>(_visible.data(), visibleCount);
+	}
+}
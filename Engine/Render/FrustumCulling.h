@@ -0,0 +1,93 @@
+#ifndef _ENGINE_FRUSTUM_CULLING_HEADER_
+#define _ENGINE_FRUSTUM_CULLING_HEADER_
+
+#include <span>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+#include "../Job/JobSystem.h"
+
+namespace engine
+{
+	/**
+	* Plane with unit normal, points with dot(normal, p) + distance >= 0 are inside
+	*/
+	struct Plane
+	{
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float distance = 0.0f;
+	};
+
+	/**
+	* Left, right, bottom, top, near and far planes of a camera, normals point inwards
+	*/
+	struct Frustum
+	{
+		Plane planes[6];
+
+		static Frustum fromViewProjection(const float (&matrix)[16]);
+	};
+
+	/**
+	* Bounding spheres as structure of arrays, element i of every array belongs to object i
+	*/
+	struct SphereBounds
+	{
+		const float* centerX = nullptr;
+		const float* centerY = nullptr;
+		const float* centerZ = nullptr;
+		const float* radius = nullptr;
+		size_t count = 0;
+	};
+
+	enum class CullKernel
+	{
+		Scalar,
+		Sse,
+		Avx2,
+	};
+
+	CullKernel detectCullKernel();
+	CullKernel parseCullKernel(const std::string_view name);
+	const char* getCullKernelName(CullKernel kernel);
+
+	size_t cullSpheres(CullKernel kernel, const Frustum& frustum, const SphereBounds& bounds, size_t first, size_t last, uint32_t* visible);
+
+	/**
+	* Culls bounding spheres against a frustum in parallel chunks and compacts the visible indices
+	* the visible list keeps the input order, so draws built from it keep their sort order
+	*/
+	class FrustumCuller
+	{
+	public:
+		FrustumCuller() = default;
+		~FrustumCuller() = default;
+
+		FrustumCuller(const FrustumCuller&) = delete;
+		FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+		void init(JobSystem* jobSystem, CullKernel kernel);
+
+		std::span<const uint32_t> cull(const Frustum& frustum, const SphereBounds& bounds);
+
+		constexpr const CullKernel getKernel() const { return _kernel; }
+
+		/* Objects per job, each chunk writes its visible indices into its own slice of the output */
+		static constexpr size_t chunkSize = 4096;
+
+		/* Vector kernels store whole registers, so every slice has room for a partial store past its end */
+		static constexpr size_t storePadding = 8;
+
+	protected:
+
+	private:
+		JobSystem* _jobSystem = nullptr;
+		CullKernel _kernel = CullKernel::Scalar;
+
+		std::vector<uint32_t> _visible;
+		std::vector<size_t> _chunkCounts;
+	};
+}
+
+#endif // !_ENGINE_FRUSTUM_CULLING_HEADER_
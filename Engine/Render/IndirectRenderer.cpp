@@ -0,0 +1,324 @@
+#include "IndirectRenderer.h"
+
+#include <array>
+#include <format>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* create descriptor set layout and one descriptor set per frame in flight, buffers are created on the first upload
+	*/
+	void IndirectRenderer::init(MemoryAllocator& allocator, BindlessHeap& bindlessHeap, uint32_t framesInFlight)
+	{
+		_allocator = &allocator;
+		_bindlessHeap = &bindlessHeap;
+		_device = allocator.getDevice();
+
+		std::array<VkDescriptorSetLayoutBinding, 4> bindings;
+		for (uint32_t i = 0; i < bindings.size(); i++)
+		{
+			bindings[i] = VkDescriptorSetLayoutBinding{
+				.binding = i,
+				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				.descriptorCount = 1,
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			};
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+			.bindingCount = static_cast<uint32_t>(bindings.size()),
+			.pBindings = bindings.data(),
+		};
+
+		if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_setLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create indirect descriptor set layout"));
+		}
+
+		VkDescriptorPoolSize poolSize{
+			.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = static_cast<uint32_t>(bindings.size()) * framesInFlight,
+		};
+
+		VkDescriptorPoolCreateInfo poolInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.maxSets = framesInFlight,
+			.poolSizeCount = 1,
+			.pPoolSizes = &poolSize,
+		};
+
+		if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_descriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create indirect descriptor pool"));
+		}
+
+		_frames.resize(framesInFlight);
+
+		std::vector<VkDescriptorSetLayout> setLayouts(framesInFlight, _setLayout);
+		std::vector<VkDescriptorSet> descriptorSets(framesInFlight);
+
+		VkDescriptorSetAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+			.descriptorPool = _descriptorPool,
+			.descriptorSetCount = framesInFlight,
+			.pSetLayouts = setLayouts.data(),
+		};
+
+		if (vkAllocateDescriptorSets(_device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to allocate indirect descriptor sets, count={}", framesInFlight));
+		}
+
+		for (uint32_t i = 0; i < framesInFlight; i++)
+		{
+			_frames[i].descriptorSet = descriptorSets[i];
+		}
+	}
+
+	/**
+	* destroy buffers and descriptors, the device has to be idle
+	*/
+	void IndirectRenderer::destroy()
+	{
+		if (_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		releaseBuffers();
+		_frames.clear();
+		_batches.clear();
+		_objectCount = 0;
+
+		vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+		_setLayout = VK_NULL_HANDLE;
+		_cullPipeline = nullptr;
+		_device = VK_NULL_HANDLE;
+	}
+
+	/**
+	* replace the objects and batches drawn every frame, the device must not use the buffers anymore
+	* batch capacities have to add up to at most the object count, commandOffset of every batch is its range in the command buffer
+	*/
+	void IndirectRenderer::upload(std::span<const GpuObject> objects, std::span<const IndirectBatch> batches)
+	{
+		reserve(static_cast<uint32_t>(objects.size()), static_cast<uint32_t>(batches.size()));
+
+		if (!objects.empty())
+		{
+			std::memcpy(_objectAllocation.mapped, objects.data(), objects.size_bytes());
+		}
+
+		/* The shader only needs the command range of a batch */
+		uint32_t* batchData = static_cast<uint32_t*>(_batchAllocation.mapped);
+		for (size_t i = 0; i < batches.size(); i++)
+		{
+			batchData[i * 2] = batches[i].commandOffset;
+			batchData[i * 2 + 1] = batches[i].capacity;
+		}
+
+		_batches.assign(batches.begin(), batches.end());
+		_objectCount = static_cast<uint32_t>(objects.size());
+
+		spdlog::debug(std::format("uploaded indirect scene, objects={}, batches={}", _objectCount, _batches.size()));
+	}
+
+	/**
+	* reset draw counts and cull every object against the frustum, visible objects append a draw command to their batch
+	*/
+	void IndirectRenderer::recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Frustum& frustum)
+	{
+		if (_objectCount == 0 || _cullPipeline == nullptr)
+		{
+			return;
+		}
+
+		FrameBuffers& frame = _frames[frameIndex];
+
+		vkCmdFillBuffer(commandBuffer, frame.counts, 0, VK_WHOLE_SIZE, 0);
+
+		VkMemoryBarrier clearBarrier{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+		};
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		CullConstants constants{};
+		for (size_t i = 0; i < 6; i++)
+		{
+			constants.planes[i][0] = frustum.planes[i].normal[0];
+			constants.planes[i][1] = frustum.planes[i].normal[1];
+			constants.planes[i][2] = frustum.planes[i].normal[2];
+			constants.planes[i][3] = frustum.planes[i].distance;
+		}
+		constants.objectCount = _objectCount;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline->pipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _cullPipeline->layout, 0, 1, &frame.descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, _cullPipeline->layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+		vkCmdDispatch(commandBuffer, (_objectCount + workgroupSize - 1) / workgroupSize, 1, 1);
+	}
+
+	/**
+	* make the commands and counts written by the cull pass visible to indirect draws, render graph frames declare this dependency instead
+	*/
+	void IndirectRenderer::recordDrawBarrier(VkCommandBuffer commandBuffer)
+	{
+		VkMemoryBarrier cullBarrier{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+		};
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	/**
+	* draw the commands written by the cull pass, one indirect count draw per batch
+	*/
+	void IndirectRenderer::recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, const RecordContext& context)
+	{
+		if (_objectCount == 0)
+		{
+			return;
+		}
+
+		FrameBuffers& frame = _frames[frameIndex];
+
+		/* Vertex shaders index the objects with the draw's first instance */
+		RecordContext frameContext = context;
+		frameContext.instanceBuffer = _objectBufferIndex;
+		bindFrameState(commandBuffer, frameContext);
+		vkCmdSetViewport(commandBuffer, 0, 1, &context.viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &context.scissor);
+
+		VkPipeline boundPipeline = VK_NULL_HANDLE;
+		const Mesh* boundMesh = nullptr;
+		for (size_t i = 0; i < _batches.size(); i++)
+		{
+			const IndirectBatch& batch = _batches[i];
+			if (batch.capacity == 0)
+			{
+				continue;
+			}
+
+			if (batch.pipeline != boundPipeline)
+			{
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline);
+				boundPipeline = batch.pipeline;
+			}
+
+			if (batch.mesh != boundMesh)
+			{
+				bindMesh(commandBuffer, *batch.mesh, context.vertexBufferCount);
+				boundMesh = batch.mesh;
+			}
+
+			vkCmdDrawIndexedIndirectCount(commandBuffer,
+				frame.commands, batch.commandOffset * sizeof(VkDrawIndexedIndirectCommand),
+				frame.counts, i * sizeof(uint32_t),
+				batch.capacity, sizeof(VkDrawIndexedIndirectCommand));
+		}
+	}
+
+	/**
+	* grow buffers to hold the given counts, existing contents are dropped
+	*/
+	void IndirectRenderer::reserve(uint32_t objectCapacity, uint32_t batchCapacity)
+	{
+		if (objectCapacity <= _objectCapacity && batchCapacity <= _batchCapacity && _objects != VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		releaseBuffers();
+
+		/* Buffers can not be empty, grow geometrically so scene reloads of similar size reuse them */
+		_objectCapacity = std::max({ objectCapacity, _objectCapacity * 2, 1u });
+		_batchCapacity = std::max({ batchCapacity, _batchCapacity, 1u });
+
+		/* Written by the CPU once per scene, read every frame, so prefer memory that is both */
+		_objects = _allocator->createBuffer(sizeof(GpuObject) * _objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _objectAllocation);
+		_objectBufferIndex = _bindlessHeap->registerBuffer(_objects);
+		_batchData = _allocator->createBuffer(sizeof(uint32_t) * 2 * _batchCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _batchAllocation);
+
+		for (FrameBuffers& frame : _frames)
+		{
+			frame.commands = _allocator->createBuffer(sizeof(VkDrawIndexedIndirectCommand) * _objectCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.commandAllocation);
+			frame.counts = _allocator->createBuffer(sizeof(uint32_t) * _batchCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, frame.countAllocation);
+		}
+
+		writeDescriptorSets();
+
+		spdlog::debug(std::format("created indirect buffers, objects={}, batches={}, frames={}", _objectCapacity, _batchCapacity, _frames.size()));
+	}
+
+	/**
+	* destroy object, batch and per frame buffers
+	*/
+	void IndirectRenderer::releaseBuffers()
+	{
+		if (_objects != VK_NULL_HANDLE)
+		{
+			_bindlessHeap->release(BindlessType::Buffer, _objectBufferIndex);
+			_allocator->destroyBuffer(_objects, _objectAllocation);
+			_allocator->destroyBuffer(_batchData, _batchAllocation);
+			_objects = VK_NULL_HANDLE;
+			_batchData = VK_NULL_HANDLE;
+		}
+
+		for (FrameBuffers& frame : _frames)
+		{
+			if (frame.commands != VK_NULL_HANDLE)
+			{
+				_allocator->destroyBuffer(frame.commands, frame.commandAllocation);
+				_allocator->destroyBuffer(frame.counts, frame.countAllocation);
+				frame.commands = VK_NULL_HANDLE;
+				frame.counts = VK_NULL_HANDLE;
+			}
+		}
+	}
+
+	/**
+	* point every frame's descriptor set at the shared object and batch buffers and its own command and count buffers
+	*/
+	void IndirectRenderer::writeDescriptorSets()
+	{
+		for (FrameBuffers& frame : _frames)
+		{
+			std::array<VkDescriptorBufferInfo, 4> bufferInfos = { {
+				{ _objects, 0, VK_WHOLE_SIZE },
+				{ _batchData, 0, VK_WHOLE_SIZE },
+				{ frame.commands, 0, VK_WHOLE_SIZE },
+				{ frame.counts, 0, VK_WHOLE_SIZE },
+			} };
+
+			std::array<VkWriteDescriptorSet, 4> writes;
+			for (uint32_t i = 0; i < writes.size(); i++)
+			{
+				writes[i] = VkWriteDescriptorSet{
+					.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+					.dstSet = frame.descriptorSet,
+					.dstBinding = i,
+					.descriptorCount = 1,
+					.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+					.pBufferInfo = &bufferInfos[i],
+				};
+			}
+
+			vkUpdateDescriptorSets(_device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		}
+	}
+}
@@ -0,0 +1,125 @@
+#ifndef _ENGINE_INDIRECT_RENDERER_HEADER_
+#define _ENGINE_INDIRECT_RENDERER_HEADER_
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "ParallelRecorder.h"
+#include "FrustumCulling.h"
+#include "BindlessHeap.h"
+#include "../Geometry/Mesh.h"
+#include "../Memory/MemoryAllocator.h"
+#include "../Compute/ComputeQueue.h"
+
+namespace engine
+{
+	/**
+	* Per object data read by the cull and vertex shaders, matches Object in cull.glsl (std430)
+	*/
+	struct GpuObject
+	{
+		float sphere[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float transform[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		uint32_t indexCount = 0;
+		uint32_t firstIndex = 0;
+		int32_t vertexOffset = 0;
+		uint32_t batch = 0;
+	};
+
+	/**
+	* Objects sharing pipeline and mesh, drawn with a single indirect count draw
+	* commandOffset and capacity select the batch's range of the command buffer
+	*/
+	struct IndirectBatch
+	{
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		const Mesh* mesh = nullptr;
+		uint32_t commandOffset = 0;
+		uint32_t capacity = 0;
+	};
+
+	/**
+	* Push constants of cull.glsl
+	*/
+	struct CullConstants
+	{
+		float planes[6][4];
+		uint32_t objectCount;
+	};
+
+	/**
+	* GPU driven draws, objects live in a storage buffer and a compute pass writes the visible ones as indirect commands
+	* recording costs one draw per batch no matter how many objects the scene has
+	* the cull pass uses its own set, vertex shaders read the objects through the bindless heap
+	*/
+	class IndirectRenderer
+	{
+	public:
+		IndirectRenderer() = default;
+		~IndirectRenderer() = default;
+
+		IndirectRenderer(const IndirectRenderer&) = delete;
+		IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+		void init(MemoryAllocator& allocator, BindlessHeap& bindlessHeap, uint32_t framesInFlight);
+		void destroy();
+
+		void setCullPipeline(const ComputePipeline* cullPipeline) { _cullPipeline = cullPipeline; }
+		void upload(std::span<const GpuObject> objects, std::span<const IndirectBatch> batches);
+
+		void recordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Frustum& frustum);
+		void recordDrawBarrier(VkCommandBuffer commandBuffer);
+		void recordDraws(VkCommandBuffer commandBuffer, uint32_t frameIndex, const RecordContext& context);
+
+		constexpr const VkDescriptorSetLayout getSetLayout() const { return _setLayout; }
+		VkBuffer getCommandBuffer(uint32_t frameIndex) const { return _frames[frameIndex].commands; }
+		VkBuffer getCountBuffer(uint32_t frameIndex) const { return _frames[frameIndex].counts; }
+		constexpr const uint32_t getObjectCount() const { return _objectCount; }
+		constexpr const size_t getBatchCount() const { return _batches.size(); }
+
+		static constexpr uint32_t workgroupSize = 64;
+
+	protected:
+
+	private:
+		/**
+		* Buffers written by the cull pass, one set per frame in flight so a frame never overwrites commands still being drawn
+		*/
+		struct FrameBuffers
+		{
+			VkBuffer commands = VK_NULL_HANDLE;
+			Allocation commandAllocation;
+			VkBuffer counts = VK_NULL_HANDLE;
+			Allocation countAllocation;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		};
+
+		MemoryAllocator* _allocator = nullptr;
+		BindlessHeap* _bindlessHeap = nullptr;
+		VkDevice _device = VK_NULL_HANDLE;
+		VkDescriptorSetLayout _setLayout = VK_NULL_HANDLE;
+		VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+		const ComputePipeline* _cullPipeline = nullptr;
+
+		VkBuffer _objects = VK_NULL_HANDLE;
+		Allocation _objectAllocation;
+		uint32_t _objectBufferIndex = 0;
+		VkBuffer _batchData = VK_NULL_HANDLE;
+		Allocation _batchAllocation;
+		std::vector<FrameBuffers> _frames;
+
+		std::vector<IndirectBatch> _batches;
+		uint32_t _objectCount = 0;
+		uint32_t _objectCapacity = 0;
+		uint32_t _batchCapacity = 0;
+
+		void reserve(uint32_t objectCapacity, uint32_t batchCapacity);
+		void releaseBuffers();
+		void writeDescriptorSets();
+	};
+}
+
+#endif // !_ENGINE_INDIRECT_RENDERER_HEADER_
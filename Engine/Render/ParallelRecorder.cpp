@@ -0,0 +1,231 @@
+#include "ParallelRecorder.h"
+
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../Profile/Profiler.h"
+
+namespace engine
+{
+	/**
+	* bind the bindless set and push the draw constants, both survive pipeline binds since all pipelines share the layout
+	*/
+	void bindFrameState(VkCommandBuffer commandBuffer, const RecordContext& context)
+	{
+		if (context.pipelineLayout == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		if (context.descriptorSet != VK_NULL_HANDLE)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context.pipelineLayout, 0, 1, &context.descriptorSet, 0, nullptr);
+		}
+
+		if (context.viewProjection != nullptr)
+		{
+			DrawConstants constants{};
+			std::copy(context.viewProjection, context.viewProjection + 16, constants.viewProjection);
+			constants.instanceBuffer = context.instanceBuffer;
+			constants.instanceOffset = context.instanceOffset;
+
+			vkCmdPushConstants(commandBuffer, context.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(DrawConstants), &constants);
+		}
+	}
+
+	/**
+	* record draws with dynamic state bound, pipelines and vertex buffers are only rebound when they change
+	*/
+	void recordDraws(VkCommandBuffer commandBuffer, const RecordContext& context, std::span<const DrawCommand> draws)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, context.pipeline);
+		bindFrameState(commandBuffer, context);
+		vkCmdSetViewport(commandBuffer, 0, 1, &context.viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &context.scissor);
+
+		VkPipeline boundPipeline = context.pipeline;
+		const Mesh* boundMesh = nullptr;
+		for (const DrawCommand& draw : draws)
+		{
+			VkPipeline pipeline = draw.pipeline != VK_NULL_HANDLE ? draw.pipeline : context.pipeline;
+			if (pipeline != boundPipeline)
+			{
+				/* Vertex buffers and dynamic state survive pipeline binds */
+				vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+				boundPipeline = pipeline;
+			}
+
+			if (draw.mesh != boundMesh)
+			{
+				bindMesh(commandBuffer, *draw.mesh, context.vertexBufferCount);
+				boundMesh = draw.mesh;
+			}
+
+			drawMesh(commandBuffer, *draw.mesh, draw.instanceCount, draw.firstInstance);
+		}
+	}
+
+	/**
+	* create one command pool per job thread and frame in flight
+	*/
+	void ParallelRecorder::init(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobSystem)
+	{
+		_device = device;
+		_jobSystem = &jobSystem;
+		_threads.resize(jobSystem.getThreadCount());
+
+		for (ThreadData& thread : _threads)
+		{
+			thread.commandPools.resize(framesInFlight);
+			thread.commandBuffers.resize(framesInFlight);
+			thread.usedBuffers.assign(framesInFlight, 0);
+
+			/* Pools are reset as a whole every frame, buffers are never reset individually */
+			for (VkCommandPool& commandPool : thread.commandPools)
+			{
+				VkCommandPoolCreateInfo poolInfo{
+					.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+					.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+					.queueFamilyIndex = queueFamily,
+				};
+
+				if (vkCreateCommandPool(_device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+				{
+					throw std::runtime_error(std::format("failed to create recording command pool"));
+				}
+			}
+		}
+	}
+
+	/**
+	* destroy command pools, together with the buffers allocated from them
+	*/
+	void ParallelRecorder::destroy()
+	{
+		for (ThreadData& thread : _threads)
+		{
+			for (VkCommandPool commandPool : thread.commandPools)
+			{
+				vkDestroyCommandPool(_device, commandPool, nullptr);
+			}
+		}
+		_threads.clear();
+		_recorded.clear();
+		_jobSystem = nullptr;
+	}
+
+	/**
+	* reset the pools of slot frameIndex that recorded since its last frame, its previous submission must have completed
+	*/
+	void ParallelRecorder::beginFrame(uint32_t frameIndex)
+	{
+		for (ThreadData& thread : _threads)
+		{
+			if (thread.usedBuffers[frameIndex] > 0)
+			{
+				vkResetCommandPool(_device, thread.commandPools[frameIndex], 0);
+				thread.usedBuffers[frameIndex] = 0;
+			}
+		}
+	}
+
+	/**
+	* record draws into secondary command buffers, returned in draw list order for vkCmdExecuteCommands
+	* the span is valid until the next call, secondaries recorded earlier in the frame are not reset by it
+	*/
+	std::span<const VkCommandBuffer> ParallelRecorder::record(uint32_t frameIndex, const RecordContext& context, std::span<const DrawCommand> draws)
+	{
+		size_t maxChunks = std::max<size_t>((draws.size() + minDrawsPerChunk - 1) / minDrawsPerChunk, 1);
+		size_t chunkCount = std::min(_threads.size(), maxChunks);
+
+		_recorded.resize(chunkCount);
+
+		_jobSystem->parallelFor(0, chunkCount, 1, [&](size_t first, size_t last) {
+			for (size_t chunk = first; chunk < last; chunk++)
+			{
+				recordChunk(frameIndex, context, draws, chunk, chunkCount);
+			}
+		});
+
+		return _recorded;
+	}
+
+	/**
+	* next free secondary of the calling thread's pool for the frame
+	*/
+	VkCommandBuffer ParallelRecorder::acquireCommandBuffer(uint32_t frameIndex)
+	{
+		ThreadData& thread = _threads[_jobSystem->getThreadIndex()];
+
+		std::vector<VkCommandBuffer>& commandBuffers = thread.commandBuffers[frameIndex];
+		if (thread.usedBuffers[frameIndex] == commandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = thread.commandPools[frameIndex],
+				.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+				.commandBufferCount = 1,
+			};
+
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to allocate secondary command buffer"));
+			}
+			commandBuffers.push_back(commandBuffer);
+		}
+
+		return commandBuffers[thread.usedBuffers[frameIndex]++];
+	}
+
+	/**
+	* record one contiguous slice of the draw list
+	*/
+	void ParallelRecorder::recordChunk(uint32_t frameIndex, const RecordContext& context, std::span<const DrawCommand> draws, size_t chunk, size_t chunkCount)
+	{
+		CpuScope scope("record chunk");
+
+		VkCommandBuffer commandBuffer = acquireCommandBuffer(frameIndex);
+
+		size_t chunkSize = (draws.size() + chunkCount - 1) / chunkCount;
+		size_t first = std::min(chunkSize * chunk, draws.size());
+		size_t last = std::min(first + chunkSize, draws.size());
+
+		/* Dynamic rendering has no render pass to inherit, the attachment formats take its place */
+		VkCommandBufferInheritanceRenderingInfo renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &context.colorFormat,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+		};
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = context.renderPass == VK_NULL_HANDLE ? &renderingInfo : nullptr,
+			.renderPass = context.renderPass,
+			.subpass = context.subpass,
+			.framebuffer = context.framebuffer,
+		};
+
+		VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+			.pInheritanceInfo = &inheritanceInfo,
+		};
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to begin secondary command buffer"));
+		}
+
+		recordDraws(commandBuffer, context, draws.subspan(first, last - first));
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to record secondary command buffer"));
+		}
+
+		_recorded[chunk] = commandBuffer;
+	}
+}
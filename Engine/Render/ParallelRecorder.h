@@ -0,0 +1,101 @@
+#ifndef _ENGINE_PARALLEL_RECORDER_HEADER_
+#define _ENGINE_PARALLEL_RECORDER_HEADER_
+
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "../Geometry/Mesh.h"
+#include "../Job/JobSystem.h"
+
+namespace engine
+{
+	/**
+	* Single indexed draw of a mesh, drawn with the context pipeline unless it names its own
+	* firstInstance selects the draw's range of the bound instance data
+	*/
+	struct DrawCommand
+	{
+		const Mesh* mesh = nullptr;
+		uint32_t instanceCount = 1;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		uint32_t firstInstance = 0;
+	};
+
+	/**
+	* Push constants of every graphics pipeline, instanceBuffer indexes the bindless buffer array
+	* instanceOffset is where this frame's instances start in that buffer, the bindless counterpart of a dynamic offset
+	*/
+	struct DrawConstants
+	{
+		float viewProjection[16];
+		uint32_t instanceBuffer;
+		uint32_t instanceOffset;
+	};
+
+	/**
+	* State every recorded chunk starts from, secondaries inherit nothing but the render pass
+	* without a render pass secondaries continue a dynamic rendering instance with a colorFormat attachment
+	* descriptorSet is the bindless set, bound once per command buffer
+	*/
+	struct RecordContext
+	{
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		uint32_t subpass = 0;
+		VkFramebuffer framebuffer = VK_NULL_HANDLE;
+		VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkViewport viewport;
+		VkRect2D scissor;
+		uint32_t vertexBufferCount = 1;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		const float* viewProjection = nullptr;
+		uint32_t instanceBuffer = 0;
+		uint32_t instanceOffset = 0;
+	};
+
+	void bindFrameState(VkCommandBuffer commandBuffer, const RecordContext& context);
+	void recordDraws(VkCommandBuffer commandBuffer, const RecordContext& context, std::span<const DrawCommand> draws);
+
+	/**
+	* Splits a draw list into contiguous chunks recorded into secondary command buffers as jobs
+	* every job thread owns one command pool per frame in flight, chunk order is the draw list order
+	* pools are reset once per frame in beginFrame, so a frame may record several passes
+	*/
+	class ParallelRecorder
+	{
+	public:
+		void init(VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, JobSystem& jobSystem);
+		void destroy();
+
+		void beginFrame(uint32_t frameIndex);
+		std::span<const VkCommandBuffer> record(uint32_t frameIndex, const RecordContext& context, std::span<const DrawCommand> draws);
+
+		constexpr const uint32_t getThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
+		constexpr const bool shouldRecordParallel(size_t drawCount) const { return _threads.size() > 1 && drawCount >= minDrawsPerChunk * 2; }
+
+		static constexpr size_t minDrawsPerChunk = 64;
+
+	protected:
+
+	private:
+		struct ThreadData
+		{
+			std::vector<VkCommandPool> commandPools;
+			std::vector<std::vector<VkCommandBuffer>> commandBuffers;
+			std::vector<uint32_t> usedBuffers;
+		};
+
+		VkDevice _device = VK_NULL_HANDLE;
+		JobSystem* _jobSystem = nullptr;
+		std::vector<ThreadData> _threads;
+		std::vector<VkCommandBuffer> _recorded;
+
+		VkCommandBuffer acquireCommandBuffer(uint32_t frameIndex);
+		void recordChunk(uint32_t frameIndex, const RecordContext& context, std::span<const DrawCommand> draws, size_t chunk, size_t chunkCount);
+	};
+}
+
+#endif // !_ENGINE_PARALLEL_RECORDER_HEADER_
@@ -0,0 +1,809 @@
+#include "RenderGraph.h"
+
+#include <format>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		/* Only writes have to be made available, reads in a source scope do nothing */
+		constexpr VkAccessFlags2 writeAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+		/**
+		* Synchronization state of a resource while barriers are being placed
+		* visible is what the last write was made visible to, reads inside it need no further barrier
+		*/
+		struct ResourceState
+		{
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 writeStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 writeAccess = VK_ACCESS_2_NONE;
+			VkPipelineStageFlags2 readStages = VK_PIPELINE_STAGE_2_NONE;
+			VkPipelineStageFlags2 visibleStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 visibleAccess = VK_ACCESS_2_NONE;
+		};
+
+		/**
+		* source and destination scope of a barrier, oldLayout is what the image is transitioned from
+		*/
+		struct Dependency
+		{
+			VkPipelineStageFlags2 srcStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 srcAccess = VK_ACCESS_2_NONE;
+			VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		/**
+		* advance state by one use, returns the dependency the use needs or nullopt when earlier barriers already cover it
+		*/
+		std::optional<Dependency> syncAccess(ResourceState& state, bool image, const AccessInfo& info)
+		{
+			bool layoutChange = image && info.layout != state.layout;
+			Dependency dependency{
+				.oldLayout = state.layout,
+			};
+
+			/* Writes and layout transitions wait for the readers since the last write, or for the write itself when nothing read it */
+			if (info.write || layoutChange)
+			{
+				if (state.readStages != VK_PIPELINE_STAGE_2_NONE)
+				{
+					dependency.srcStages = state.readStages;
+				}
+				else
+				{
+					dependency.srcStages = state.writeStages;
+					dependency.srcAccess = state.writeAccess;
+				}
+
+				state.layout = image ? info.layout : state.layout;
+				if (info.write)
+				{
+					state.writeStages = info.stages;
+					state.writeAccess = info.access & writeAccessMask;
+					state.readStages = VK_PIPELINE_STAGE_2_NONE;
+					state.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+					state.visibleAccess = VK_ACCESS_2_NONE;
+				}
+				else
+				{
+					/* Later readers chain behind the transition */
+					state.writeStages = info.stages;
+					state.readStages = info.stages;
+					state.visibleStages = info.stages;
+					state.visibleAccess = info.access;
+				}
+
+				if (dependency.srcStages == VK_PIPELINE_STAGE_2_NONE && !layoutChange)
+				{
+					return std::nullopt;
+				}
+				return dependency;
+			}
+
+			/* Reads only wait for the last write, and only if it was not made visible to them yet */
+			state.readStages |= info.stages;
+			if (state.writeStages == VK_PIPELINE_STAGE_2_NONE && state.writeAccess == VK_ACCESS_2_NONE)
+			{
+				return std::nullopt;
+			}
+
+			if ((info.stages & ~state.visibleStages) == 0 && (info.access & ~state.visibleAccess) == 0)
+			{
+				return std::nullopt;
+			}
+
+			dependency.srcStages = state.writeStages;
+			dependency.srcAccess = state.writeAccess;
+			state.visibleStages |= info.stages;
+			state.visibleAccess |= info.access;
+
+			return dependency;
+		}
+
+		constexpr VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+
+		/**
+		* image create info of a transient, every transient is a single mip 2D image
+		*/
+		VkImageCreateInfo getImageCreateInfo(const TransientImageDesc& desc)
+		{
+			return VkImageCreateInfo{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+				.imageType = VK_IMAGE_TYPE_2D,
+				.format = desc.format,
+				.extent = { desc.extent.width, desc.extent.height, 1 },
+				.mipLevels = 1,
+				.arrayLayers = 1,
+				.samples = VK_SAMPLE_COUNT_1_BIT,
+				.tiling = VK_IMAGE_TILING_OPTIMAL,
+				.usage = desc.usage,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+				.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			};
+		}
+	}
+
+	/**
+	* stages, access and layout of a kind of use
+	*/
+	AccessInfo getAccessInfo(ResourceAccess access)
+	{
+		switch (access)
+		{
+		case ResourceAccess::ColorAttachmentWrite:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true };
+		case ResourceAccess::ColorAttachmentRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, false };
+		case ResourceAccess::DepthAttachmentWrite:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true };
+		case ResourceAccess::DepthAttachmentRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL, false };
+		case ResourceAccess::SampledRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false };
+		case ResourceAccess::StorageRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+				VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, false };
+		case ResourceAccess::StorageWrite:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true };
+		case ResourceAccess::IndirectRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false };
+		case ResourceAccess::TransferRead:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false };
+		case ResourceAccess::TransferWrite:
+			return AccessInfo{ VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true };
+		case ResourceAccess::Present:
+			/* Presentation is ordered by a semaphore, only the layout matters */
+			return AccessInfo{ VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false };
+		default:
+			throw std::runtime_error(std::format("unknown resource access, access={}", static_cast<uint32_t>(access)));
+		}
+	}
+
+	/**
+	* keep the allocator transient memory comes from
+	*/
+	void RenderGraph::init(MemoryAllocator& allocator, uint32_t framesInFlight)
+	{
+		_allocator = &allocator;
+		_device = allocator.getDevice();
+		_retired.assign(framesInFlight, {});
+		_frameIndex = 0;
+	}
+
+	/**
+	* destroy transient images and memory, the device has to be idle
+	*/
+	void RenderGraph::destroy()
+	{
+		if (_allocator == nullptr)
+		{
+			return;
+		}
+
+		for (std::vector<RetiredTransients>& retired : _retired)
+		{
+			for (RetiredTransients& transients : retired)
+			{
+				destroyTransients(transients.images, transients.allocation);
+			}
+		}
+		_retired.clear();
+
+		destroyTransients(_transients, _transientAllocation);
+		reset();
+
+		_allocator = nullptr;
+		_device = VK_NULL_HANDLE;
+	}
+
+	/**
+	* destroy transients retired the last time frameIndex was recorded, call after waiting for the frame's fence
+	*/
+	void RenderGraph::beginFrame(uint32_t frameIndex)
+	{
+		_frameIndex = frameIndex;
+
+		for (RetiredTransients& transients : _retired[frameIndex])
+		{
+			destroyTransients(transients.images, transients.allocation);
+		}
+		_retired[frameIndex].clear();
+	}
+
+	/**
+	* drop the passes and resources of the previous frame, transient images are kept for reuse
+	*/
+	void RenderGraph::reset()
+	{
+		_resources.clear();
+		_passes.clear();
+		_order.clear();
+		_barriers.clear();
+		_finalBarriers = {};
+		_culledPassCount = 0;
+		_barrierCount = 0;
+	}
+
+	/**
+	* register an image owned outside the graph, initial is the last use before the graph runs
+	*/
+	RenderResource RenderGraph::importImage(const std::string_view name, VkImage image, VkImageView imageView, VkImageAspectFlags aspect, const AccessInfo& initial)
+	{
+		_resources.push_back(Resource{
+			.name = std::string(name),
+			.kind = ResourceKind::ImportedImage,
+			.image = image,
+			.imageView = imageView,
+			.aspect = aspect,
+			.initial = initial,
+		});
+
+		return static_cast<RenderResource>(_resources.size() - 1);
+	}
+
+	/**
+	* register a buffer owned outside the graph, initial is the last use before the graph runs
+	*/
+	RenderResource RenderGraph::importBuffer(const std::string_view name, VkBuffer buffer, const AccessInfo& initial)
+	{
+		_resources.push_back(Resource{
+			.name = std::string(name),
+			.kind = ResourceKind::ImportedBuffer,
+			.buffer = buffer,
+			.initial = initial,
+		});
+
+		return static_cast<RenderResource>(_resources.size() - 1);
+	}
+
+	/**
+	* declare an image the graph creates, its contents do not survive the frame
+	*/
+	RenderResource RenderGraph::createImage(const std::string_view name, const TransientImageDesc& desc)
+	{
+		_resources.push_back(Resource{
+			.name = std::string(name),
+			.kind = ResourceKind::TransientImage,
+			.aspect = desc.aspect,
+			.desc = desc,
+		});
+
+		return static_cast<RenderResource>(_resources.size() - 1);
+	}
+
+	/**
+	* add a pass recorded by record, passes execute in the order they were added
+	*/
+	uint32_t RenderGraph::addPass(const std::string_view name, RecordPass record)
+	{
+		_passes.push_back(Pass{
+			.name = std::string(name),
+			.record = std::move(record),
+		});
+
+		return static_cast<uint32_t>(_passes.size() - 1);
+	}
+
+	/**
+	* declare that pass reads resource, passes reading an attachment they also render to declare both
+	*/
+	void RenderGraph::read(uint32_t pass, RenderResource resource, ResourceAccess access)
+	{
+		AccessInfo info = getAccessInfo(access);
+		info.write = false;
+		addAccess(pass, resource, info);
+	}
+
+	/**
+	* declare that pass writes resource
+	*/
+	void RenderGraph::write(uint32_t pass, RenderResource resource, ResourceAccess access)
+	{
+		AccessInfo info = getAccessInfo(access);
+		info.write = true;
+		addAccess(pass, resource, info);
+	}
+
+	/**
+	* keep every pass contributing to resource, finalAccess is the use it is left ready for after the graph
+	*/
+	void RenderGraph::markOutput(RenderResource resource, ResourceAccess finalAccess)
+	{
+		_resources[resource].output = true;
+		_resources[resource].finalAccess = getAccessInfo(finalAccess);
+	}
+
+	/**
+	* cull passes, place transients and barriers, call after every pass was added
+	*/
+	void RenderGraph::compile()
+	{
+		cullPasses();
+		computeLifetimes();
+		placeTransients();
+		buildBarriers();
+	}
+
+	/**
+	* record every live pass preceded by its barriers, followed by the transitions of the outputs
+	*/
+	void RenderGraph::execute(VkCommandBuffer commandBuffer) const
+	{
+		/* One barrier command per batch */
+		auto recordBarriers = [commandBuffer](const BarrierBatch& batch) {
+			if (batch.imageBarriers.empty() && batch.bufferBarriers.empty())
+			{
+				return;
+			}
+
+			VkDependencyInfo dependencyInfo{
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.bufferMemoryBarrierCount = static_cast<uint32_t>(batch.bufferBarriers.size()),
+				.pBufferMemoryBarriers = batch.bufferBarriers.data(),
+				.imageMemoryBarrierCount = static_cast<uint32_t>(batch.imageBarriers.size()),
+				.pImageMemoryBarriers = batch.imageBarriers.data(),
+			};
+
+			vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+		};
+
+		for (size_t i = 0; i < _order.size(); i++)
+		{
+			recordBarriers(_barriers[i]);
+			_passes[_order[i]].record(commandBuffer, *this);
+		}
+
+		recordBarriers(_finalBarriers);
+	}
+
+	/**
+	* image of a resource, transient images are valid after compile and null when only culled passes use them
+	*/
+	VkImage RenderGraph::getImage(RenderResource resource) const
+	{
+		const Resource& entry = _resources[resource];
+		return entry.transient != UINT32_MAX ? _transients[entry.transient].image : entry.image;
+	}
+
+	/**
+	* view of a resource, transient views are valid after compile
+	*/
+	VkImageView RenderGraph::getImageView(RenderResource resource) const
+	{
+		const Resource& entry = _resources[resource];
+		return entry.transient != UINT32_MAX ? _transients[entry.transient].imageView : entry.imageView;
+	}
+
+	/**
+	* offset of a transient image in the shared transient memory, valid after compile, 0 for imported and unplaced resources
+	*/
+	VkDeviceSize RenderGraph::getTransientOffset(RenderResource resource) const
+	{
+		const Resource& entry = _resources[resource];
+		return entry.transient != UINT32_MAX ? _transients[entry.transient].offset : 0;
+	}
+
+	/**
+	* merge a use into the pass's entry for the resource, an image can only be in one layout during a pass
+	*/
+	void RenderGraph::addAccess(uint32_t pass, RenderResource resource, const AccessInfo& info)
+	{
+		std::vector<PassAccess>& accesses = _passes[pass].accesses;
+		std::vector<PassAccess>::iterator it = std::find_if(accesses.begin(), accesses.end(), [resource](const PassAccess& access) { return access.resource == resource; });
+
+		if (it == accesses.end())
+		{
+			accesses.push_back(PassAccess{
+				.resource = resource,
+				.info = info,
+				.reads = !info.write,
+				.writes = info.write,
+			});
+			return;
+		}
+
+		if (_resources[resource].kind != ResourceKind::ImportedBuffer && it->info.layout != info.layout)
+		{
+			throw std::runtime_error(std::format("conflicting image layouts in one pass, pass={}, resource={}", _passes[pass].name, _resources[resource].name));
+		}
+
+		it->info.stages |= info.stages;
+		it->info.access |= info.access;
+		it->info.write = it->info.write || info.write;
+		it->reads = it->reads || !info.write;
+		it->writes = it->writes || info.write;
+	}
+
+	/**
+	* walk passes backwards from the outputs, a pass lives if it has side effects or writes something a later live pass or an output needs
+	*/
+	void RenderGraph::cullPasses()
+	{
+		std::vector<bool> needed(_resources.size(), false);
+		for (size_t i = 0; i < _resources.size(); i++)
+		{
+			needed[i] = _resources[i].output;
+		}
+
+		for (size_t i = _passes.size(); i-- > 0;)
+		{
+			Pass& pass = _passes[i];
+			pass.culled = !pass.sideEffects && std::none_of(pass.accesses.begin(), pass.accesses.end(), [&needed](const PassAccess& access) {
+				return access.writes && needed[access.resource];
+			});
+
+			if (pass.culled)
+			{
+				continue;
+			}
+
+			/* Earlier writers are only needed when this pass keeps their contents */
+			for (const PassAccess& access : pass.accesses)
+			{
+				if (access.writes && !access.reads)
+				{
+					needed[access.resource] = false;
+				}
+			}
+			for (const PassAccess& access : pass.accesses)
+			{
+				if (access.reads)
+				{
+					needed[access.resource] = true;
+				}
+			}
+		}
+
+		_order.clear();
+		for (uint32_t i = 0; i < _passes.size(); i++)
+		{
+			if (!_passes[i].culled)
+			{
+				_order.push_back(i);
+			}
+		}
+		_culledPassCount = static_cast<uint32_t>(_passes.size() - _order.size());
+	}
+
+	/**
+	* first and last position in the execution order every resource is used at
+	*/
+	void RenderGraph::computeLifetimes()
+	{
+		for (Resource& resource : _resources)
+		{
+			resource.firstPass = UINT32_MAX;
+			resource.lastPass = 0;
+		}
+
+		for (uint32_t i = 0; i < _order.size(); i++)
+		{
+			for (const PassAccess& access : _passes[_order[i]].accesses)
+			{
+				Resource& resource = _resources[access.resource];
+				resource.firstPass = std::min(resource.firstPass, i);
+				resource.lastPass = std::max(resource.lastPass, i);
+			}
+		}
+	}
+
+	/**
+	* place used transient images in one allocation, images whose lifetimes don't overlap may share memory
+	* largest images are placed first, each at the lowest offset clear of every placed image alive at the same time
+	*/
+	void RenderGraph::placeTransients()
+	{
+		std::vector<RenderResource> used;
+		for (RenderResource i = 0; i < _resources.size(); i++)
+		{
+			if (_resources[i].kind == ResourceKind::TransientImage && _resources[i].firstPass != UINT32_MAX)
+			{
+				used.push_back(i);
+			}
+		}
+
+		std::vector<TransientImage> placed(used.size());
+		for (size_t i = 0; i < used.size(); i++)
+		{
+			VkImageCreateInfo imageInfo = getImageCreateInfo(_resources[used[i]].desc);
+			VkDeviceImageMemoryRequirements requirementsInfo{
+				.sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+				.pCreateInfo = &imageInfo,
+			};
+			VkMemoryRequirements2 requirements{
+				.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+			};
+			vkGetDeviceImageMemoryRequirements(_device, &requirementsInfo, &requirements);
+
+			placed[i].desc = _resources[used[i]].desc;
+			placed[i].requirements = requirements.memoryRequirements;
+		}
+
+		std::vector<size_t> bySize(used.size());
+		std::iota(bySize.begin(), bySize.end(), 0);
+		std::stable_sort(bySize.begin(), bySize.end(), [&placed](size_t a, size_t b) { return placed[a].requirements.size > placed[b].requirements.size; });
+
+		VkMemoryRequirements total{
+			.size = 0,
+			.alignment = 1,
+			.memoryTypeBits = UINT32_MAX,
+		};
+		VkDeviceSize unaliasedBytes = 0;
+		std::vector<size_t> done;
+
+		for (size_t i : bySize)
+		{
+			const Resource& resource = _resources[used[i]];
+			const VkMemoryRequirements& requirements = placed[i].requirements;
+
+			/* Candidates are the start of memory and the end of every conflicting image, the lowest that fits wins */
+			std::vector<VkDeviceSize> candidates = { 0 };
+			for (size_t j : done)
+			{
+				const Resource& other = _resources[used[j]];
+				if (resource.firstPass <= other.lastPass && other.firstPass <= resource.lastPass)
+				{
+					candidates.push_back(alignUp(placed[j].offset + placed[j].requirements.size, requirements.alignment));
+				}
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			for (VkDeviceSize offset : candidates)
+			{
+				bool fits = std::none_of(done.begin(), done.end(), [&](size_t j) {
+					const Resource& other = _resources[used[j]];
+					bool alive = resource.firstPass <= other.lastPass && other.firstPass <= resource.lastPass;
+					return alive && offset < placed[j].offset + placed[j].requirements.size && placed[j].offset < offset + requirements.size;
+				});
+
+				if (fits)
+				{
+					placed[i].offset = offset;
+					break;
+				}
+			}
+
+			done.push_back(i);
+			total.size = std::max(total.size, placed[i].offset + requirements.size);
+			total.alignment = std::max(total.alignment, requirements.alignment);
+			total.memoryTypeBits &= requirements.memoryTypeBits;
+			unaliasedBytes += alignUp(requirements.size, requirements.alignment);
+		}
+
+		for (size_t i = 0; i < used.size(); i++)
+		{
+			_resources[used[i]].transient = static_cast<uint32_t>(i);
+		}
+
+		/* Same images at the same offsets as last frame, keep them */
+		bool unchanged = placed.size() == _transients.size() && std::equal(placed.begin(), placed.end(), _transients.begin(), [](const TransientImage& a, const TransientImage& b) {
+			return a.desc == b.desc && a.offset == b.offset;
+		});
+
+		if (unchanged)
+		{
+			return;
+		}
+
+		retireTransients();
+		_transients = std::move(placed);
+		_transientBytes = total.size;
+		_unaliasedBytes = unaliasedBytes;
+
+		if (_transients.empty())
+		{
+			return;
+		}
+
+		_transientAllocation = _allocator->allocate(total, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, false);
+
+		for (size_t i = 0; i < _transients.size(); i++)
+		{
+			TransientImage& transient = _transients[i];
+			VkImageCreateInfo imageInfo = getImageCreateInfo(transient.desc);
+
+			if (vkCreateImage(_device, &imageInfo, nullptr, &transient.image) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create transient image, name={}", _resources[used[i]].name));
+			}
+
+			if (vkBindImageMemory(_device, transient.image, _transientAllocation.memory, _transientAllocation.offset + transient.offset) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to bind transient image memory, name={}", _resources[used[i]].name));
+			}
+
+			VkImageViewCreateInfo viewInfo{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image = transient.image,
+				.viewType = VK_IMAGE_VIEW_TYPE_2D,
+				.format = transient.desc.format,
+				.subresourceRange = {
+					.aspectMask = transient.desc.aspect,
+					.baseMipLevel = 0,
+					.levelCount = 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+			};
+
+			if (vkCreateImageView(_device, &viewInfo, nullptr, &transient.imageView) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create transient image view, name={}", _resources[used[i]].name));
+			}
+		}
+
+		spdlog::debug(std::format("placed transient images, images={}, bytes={}, unaliasedBytes={}", _transients.size(), _transientBytes, _unaliasedBytes));
+	}
+
+	/**
+	* simulate the resource states over the execution order and emit a barrier only where a use is not covered yet
+	* barriers of one pass are batched into a single command
+	*/
+	void RenderGraph::buildBarriers()
+	{
+		std::vector<ResourceState> states(_resources.size());
+		std::vector<AccessInfo> lastUses(_resources.size());
+
+		for (uint32_t i = 0; i < _order.size(); i++)
+		{
+			for (const PassAccess& access : _passes[_order[i]].accesses)
+			{
+				if (_resources[access.resource].lastPass == i)
+				{
+					lastUses[access.resource] = access.info;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < _resources.size(); i++)
+		{
+			const Resource& resource = _resources[i];
+			if (resource.kind != ResourceKind::TransientImage)
+			{
+				states[i].layout = resource.initial.layout;
+				states[i].writeStages = resource.initial.stages;
+				states[i].writeAccess = resource.initial.access;
+				continue;
+			}
+
+			if (resource.transient == UINT32_MAX)
+			{
+				continue;
+			}
+
+			/* Contents are discarded, the first use only waits for whatever last used the same memory, including last frame's use of itself */
+			const TransientImage& transient = _transients[resource.transient];
+			for (size_t j = 0; j < _resources.size(); j++)
+			{
+				const Resource& other = _resources[j];
+				if (other.kind != ResourceKind::TransientImage || other.transient == UINT32_MAX)
+				{
+					continue;
+				}
+
+				const TransientImage& otherTransient = _transients[other.transient];
+				if (transient.offset < otherTransient.offset + otherTransient.requirements.size && otherTransient.offset < transient.offset + transient.requirements.size)
+				{
+					states[i].writeStages |= lastUses[j].stages;
+					states[i].writeAccess |= lastUses[j].access & writeAccessMask;
+				}
+			}
+		}
+
+		/* Append the barrier a use needs, if any */
+		auto sync = [this, &states](RenderResource index, const AccessInfo& info, BarrierBatch& batch) {
+			const Resource& resource = _resources[index];
+			bool image = resource.kind != ResourceKind::ImportedBuffer;
+
+			std::optional<Dependency> dependency = syncAccess(states[index], image, info);
+			if (!dependency)
+			{
+				return;
+			}
+
+			_barrierCount++;
+			if (!image)
+			{
+				batch.bufferBarriers.push_back(VkBufferMemoryBarrier2{
+					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+					.srcStageMask = dependency->srcStages,
+					.srcAccessMask = dependency->srcAccess,
+					.dstStageMask = info.stages,
+					.dstAccessMask = info.access,
+					.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+					.buffer = resource.buffer,
+					.offset = 0,
+					.size = VK_WHOLE_SIZE,
+				});
+				return;
+			}
+
+			batch.imageBarriers.push_back(VkImageMemoryBarrier2{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = dependency->srcStages,
+				.srcAccessMask = dependency->srcAccess,
+				.dstStageMask = info.stages,
+				.dstAccessMask = info.access,
+				.oldLayout = dependency->oldLayout,
+				.newLayout = info.layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = getImage(index),
+				.subresourceRange = {
+					.aspectMask = resource.aspect,
+					.baseMipLevel = 0,
+					.levelCount = VK_REMAINING_MIP_LEVELS,
+					.baseArrayLayer = 0,
+					.layerCount = VK_REMAINING_ARRAY_LAYERS,
+				},
+			});
+		};
+
+		_barriers.assign(_order.size(), {});
+		for (size_t i = 0; i < _order.size(); i++)
+		{
+			for (const PassAccess& access : _passes[_order[i]].accesses)
+			{
+				sync(access.resource, access.info, _barriers[i]);
+			}
+		}
+
+		for (RenderResource i = 0; i < _resources.size(); i++)
+		{
+			if (_resources[i].output && _resources[i].firstPass != UINT32_MAX)
+			{
+				sync(i, _resources[i].finalAccess, _finalBarriers);
+			}
+		}
+	}
+
+	/**
+	* hand the current transients to the frame being recorded, they are destroyed when its slot comes around again
+	*/
+	void RenderGraph::retireTransients()
+	{
+		if (_transients.empty() && !_transientAllocation.isValid())
+		{
+			return;
+		}
+
+		_retired[_frameIndex].push_back(RetiredTransients{
+			.images = std::move(_transients),
+			.allocation = _transientAllocation,
+		});
+		_transients.clear();
+		_transientAllocation = {};
+	}
+
+	/**
+	* destroy images and views, then free their shared memory
+	*/
+	void RenderGraph::destroyTransients(std::vector<TransientImage>& images, Allocation& allocation)
+	{
+		for (TransientImage& transient : images)
+		{
+			vkDestroyImageView(_device, transient.imageView, nullptr);
+			vkDestroyImage(_device, transient.image, nullptr);
+		}
+		images.clear();
+
+		if (allocation.isValid())
+		{
+			_allocator->free(allocation);
+		}
+	}
+}
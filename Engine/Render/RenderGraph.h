@@ -0,0 +1,228 @@
+#ifndef _ENGINE_RENDER_GRAPH_HEADER_
+#define _ENGINE_RENDER_GRAPH_HEADER_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+#include "../Memory/MemoryAllocator.h"
+
+namespace engine
+{
+	/**
+	* Ways a pass can use a resource, each maps to the stages, access and image layout of getAccessInfo
+	*/
+	enum class ResourceAccess : uint32_t
+	{
+		ColorAttachmentWrite,
+		ColorAttachmentRead,
+		DepthAttachmentWrite,
+		DepthAttachmentRead,
+		SampledRead,
+		StorageRead,
+		StorageWrite,
+		IndirectRead,
+		TransferRead,
+		TransferWrite,
+		Present,
+	};
+
+	/**
+	* Synchronization scope of one use of a resource, layout is ignored for buffers
+	*/
+	struct AccessInfo
+	{
+		VkPipelineStageFlags2 stages = VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2 access = VK_ACCESS_2_NONE;
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		bool write = false;
+	};
+
+	AccessInfo getAccessInfo(ResourceAccess access);
+
+	/**
+	* Image created and owned by the graph, it lives from its first to its last use within a frame
+	*/
+	struct TransientImageDesc
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent = { 0, 0 };
+		VkImageUsageFlags usage = 0;
+		VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+
+		constexpr bool operator==(const TransientImageDesc& other) const
+		{
+			return format == other.format && extent.width == other.extent.width && extent.height == other.extent.height
+				&& usage == other.usage && aspect == other.aspect;
+		}
+	};
+
+	using RenderResource = uint32_t;
+
+	class RenderGraph;
+	using RecordPass = std::function<void(VkCommandBuffer, const RenderGraph&)>;
+
+	/**
+	* Frame described as passes declaring what they read and write, rebuilt every frame and compiled before execution
+	* compile culls passes that contribute nothing to an output, places the fewest synchronization2 barriers that satisfy every hazard
+	* and packs transient images whose lifetimes don't overlap into the same memory
+	* the packed memory and its images are kept across frames for as long as the transient layout stays the same
+	*/
+	class RenderGraph
+	{
+	public:
+		RenderGraph() = default;
+		~RenderGraph() = default;
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		void init(MemoryAllocator& allocator, uint32_t framesInFlight);
+		void destroy();
+
+		void beginFrame(uint32_t frameIndex);
+		void reset();
+
+		RenderResource importImage(const std::string_view name, VkImage image, VkImageView imageView, VkImageAspectFlags aspect, const AccessInfo& initial);
+		RenderResource importBuffer(const std::string_view name, VkBuffer buffer, const AccessInfo& initial = {});
+		RenderResource createImage(const std::string_view name, const TransientImageDesc& desc);
+
+		uint32_t addPass(const std::string_view name, RecordPass record);
+		void read(uint32_t pass, RenderResource resource, ResourceAccess access);
+		void write(uint32_t pass, RenderResource resource, ResourceAccess access);
+		void setSideEffects(uint32_t pass) { _passes[pass].sideEffects = true; }
+		void markOutput(RenderResource resource, ResourceAccess finalAccess);
+
+		void compile();
+		void execute(VkCommandBuffer commandBuffer) const;
+
+		VkImage getImage(RenderResource resource) const;
+		VkImageView getImageView(RenderResource resource) const;
+		VkBuffer getBuffer(RenderResource resource) const { return _resources[resource].buffer; }
+		VkDeviceSize getTransientOffset(RenderResource resource) const;
+
+		constexpr const size_t getPassCount() const { return _passes.size(); }
+		constexpr const uint32_t getCulledPassCount() const { return _culledPassCount; }
+		constexpr const uint32_t getBarrierCount() const { return _barrierCount; }
+		constexpr const VkDeviceSize getTransientBytes() const { return _transientBytes; }
+		constexpr const VkDeviceSize getUnaliasedBytes() const { return _unaliasedBytes; }
+
+	protected:
+
+	private:
+		enum class ResourceKind
+		{
+			ImportedImage,
+			ImportedBuffer,
+			TransientImage,
+		};
+
+		/**
+		* Resource of the current frame, transient images point into _transients
+		*/
+		struct Resource
+		{
+			std::string name;
+			ResourceKind kind = ResourceKind::ImportedImage;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView imageView = VK_NULL_HANDLE;
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+			AccessInfo initial;
+			TransientImageDesc desc;
+			uint32_t transient = UINT32_MAX;
+
+			bool output = false;
+			AccessInfo finalAccess;
+
+			/* First and last live pass using the resource, filled by compile */
+			uint32_t firstPass = UINT32_MAX;
+			uint32_t lastPass = 0;
+		};
+
+		/**
+		* One resource use of a pass, reads and writes of the same resource are merged
+		*/
+		struct PassAccess
+		{
+			RenderResource resource = 0;
+			AccessInfo info;
+			bool reads = false;
+			bool writes = false;
+		};
+
+		/**
+		* Pass of the current frame, culled passes are neither given barriers nor recorded
+		*/
+		struct Pass
+		{
+			std::string name;
+			RecordPass record;
+			std::vector<PassAccess> accesses;
+			bool sideEffects = false;
+			bool culled = false;
+		};
+
+		/**
+		* Barriers recorded right before a pass, or after the last one for outputs
+		*/
+		struct BarrierBatch
+		{
+			std::vector<VkImageMemoryBarrier2> imageBarriers;
+			std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+		};
+
+		/**
+		* Image placed in the shared transient memory at offset, kept until the transient layout changes
+		*/
+		struct TransientImage
+		{
+			TransientImageDesc desc;
+			VkImage image = VK_NULL_HANDLE;
+			VkImageView imageView = VK_NULL_HANDLE;
+			VkMemoryRequirements requirements{};
+			VkDeviceSize offset = 0;
+		};
+
+		/**
+		* Transient images and memory of a previous layout, destroyed once the frames using them have finished
+		*/
+		struct RetiredTransients
+		{
+			std::vector<TransientImage> images;
+			Allocation allocation;
+		};
+
+		MemoryAllocator* _allocator = nullptr;
+		VkDevice _device = VK_NULL_HANDLE;
+
+		std::vector<Resource> _resources;
+		std::vector<Pass> _passes;
+		std::vector<uint32_t> _order;
+		std::vector<BarrierBatch> _barriers;
+		BarrierBatch _finalBarriers;
+
+		std::vector<TransientImage> _transients;
+		Allocation _transientAllocation;
+		std::vector<std::vector<RetiredTransients>> _retired;
+		uint32_t _frameIndex = 0;
+
+		uint32_t _culledPassCount = 0;
+		uint32_t _barrierCount = 0;
+		VkDeviceSize _transientBytes = 0;
+		VkDeviceSize _unaliasedBytes = 0;
+
+		void addAccess(uint32_t pass, RenderResource resource, const AccessInfo& info);
+		void cullPasses();
+		void computeLifetimes();
+		void placeTransients();
+		void buildBarriers();
+		void retireTransients();
+		void destroyTransients(std::vector<TransientImage>& images, Allocation& allocation);
+	};
+}
+
+#endif // !_ENGINE_RENDER_GRAPH_HEADER_
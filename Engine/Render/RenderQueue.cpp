@@ -0,0 +1,302 @@
+#include "RenderQueue.h"
+
+#include <array>
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	namespace
+	{
+		constexpr uint32_t radixBits = 8;
+		constexpr uint32_t radixSize = 1u << radixBits;
+		constexpr uint32_t digitCount = 64 / radixBits;
+
+		using Histogram = std::array<uint32_t, radixSize>;
+
+		constexpr uint32_t getDigit(uint64_t key, uint32_t digit)
+		{
+			return static_cast<uint32_t>(key >> (digit * radixBits)) & (radixSize - 1);
+		}
+
+		/**
+		* clamp value to the field and shift it into place
+		*/
+		constexpr uint64_t packField(uint32_t value, uint32_t bits, uint32_t shift)
+		{
+			uint32_t maximum = (1u << bits) - 1;
+			return static_cast<uint64_t>(std::min(value, maximum)) << shift;
+		}
+	}
+
+	/**
+	* pack the item into its sort key, depth is quantized to the depth bits
+	*/
+	uint64_t SortKey::make(const RenderItem& item)
+	{
+		uint32_t depthMaximum = (1u << depthBits) - 1;
+		uint32_t depth = static_cast<uint32_t>(std::clamp(item.depth, 0.0f, 1.0f) * static_cast<float>(depthMaximum));
+
+		return packField(item.pass, passBits, passShift)
+			| packField(item.pipeline, pipelineBits, pipelineShift)
+			| packField(item.material, materialBits, materialShift)
+			| packField(item.mesh, meshBits, meshShift)
+			| packField(depth, depthBits, 0);
+	}
+
+	/**
+	* stable least significant digit radix sort over 8-bit digits, counting and scattering run per chunk on the job system
+	* digits every key shares are skipped, so keys differing in few fields sort in few passes
+	*/
+	void radixSort(JobSystem* jobSystem, std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch)
+	{
+		size_t count = entries.size();
+		if (count <= 1)
+		{
+			return;
+		}
+
+		scratch.resize(count);
+
+		bool parallel = jobSystem != nullptr && jobSystem->getThreadCount() > 1 && count > RenderQueue::sortChunkSize;
+		size_t chunkSize = parallel ? RenderQueue::sortChunkSize : count;
+		size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+		/* Histograms of every digit and chunk, the first pass counts all digits at once */
+		std::vector<std::array<Histogram, digitCount>> histograms(chunkCount);
+
+		auto forEachChunk = [&](auto&& function)
+		{
+			if (parallel)
+			{
+				jobSystem->parallelFor(0, chunkCount, 1, [&function](size_t first, size_t last)
+				{
+					for (size_t chunk = first; chunk < last; chunk++)
+					{
+						function(chunk);
+					}
+				});
+			}
+			else
+			{
+				for (size_t chunk = 0; chunk < chunkCount; chunk++)
+				{
+					function(chunk);
+				}
+			}
+		};
+
+		forEachChunk([&](size_t chunk)
+		{
+			std::array<Histogram, digitCount>& histogram = histograms[chunk];
+			for (Histogram& digitHistogram : histogram)
+			{
+				digitHistogram.fill(0);
+			}
+
+			size_t last = std::min(count, (chunk + 1) * chunkSize);
+			for (size_t i = chunk * chunkSize; i < last; i++)
+			{
+				for (uint32_t digit = 0; digit < digitCount; digit++)
+				{
+					histogram[digit][getDigit(entries[i].key, digit)]++;
+				}
+			}
+		});
+
+		std::vector<SortEntry>* source = &entries;
+		std::vector<SortEntry>* destination = &scratch;
+		std::vector<Histogram> offsets(chunkCount);
+		bool countsValid = true;
+
+		for (uint32_t digit = 0; digit < digitCount; digit++)
+		{
+			/* Chunk contents change with every scatter, so later digits are counted again */
+			if (!countsValid)
+			{
+				forEachChunk([&](size_t chunk)
+				{
+					Histogram& histogram = histograms[chunk][digit];
+					histogram.fill(0);
+
+					size_t last = std::min(count, (chunk + 1) * chunkSize);
+					for (size_t i = chunk * chunkSize; i < last; i++)
+					{
+						histogram[getDigit((*source)[i].key, digit)]++;
+					}
+				});
+			}
+
+			/* Chunk totals are independent of the order, one full bucket means every key shares this digit */
+			Histogram total{};
+			for (size_t chunk = 0; chunk < chunkCount; chunk++)
+			{
+				for (uint32_t bucket = 0; bucket < radixSize; bucket++)
+				{
+					total[bucket] += histograms[chunk][digit][bucket];
+				}
+			}
+
+			if (std::find(total.begin(), total.end(), static_cast<uint32_t>(count)) != total.end())
+			{
+				continue;
+			}
+
+			/* Bucket major, chunk minor offsets keep equal digits in input order */
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < radixSize; bucket++)
+			{
+				for (size_t chunk = 0; chunk < chunkCount; chunk++)
+				{
+					offsets[chunk][bucket] = offset;
+					offset += histograms[chunk][digit][bucket];
+				}
+			}
+
+			forEachChunk([&](size_t chunk)
+			{
+				Histogram& chunkOffsets = offsets[chunk];
+
+				size_t last = std::min(count, (chunk + 1) * chunkSize);
+				for (size_t i = chunk * chunkSize; i < last; i++)
+				{
+					const SortEntry& entry = (*source)[i];
+					(*destination)[chunkOffsets[getDigit(entry.key, digit)]++] = entry;
+				}
+			});
+
+			std::swap(source, destination);
+			countsValid = false;
+		}
+
+		if (source != &entries)
+		{
+			entries.swap(scratch);
+		}
+	}
+
+	/**
+	* keep the job system the sort is spread over
+	*/
+	void RenderQueue::init(JobSystem* jobSystem)
+	{
+		_jobSystem = jobSystem;
+	}
+
+	/**
+	* drop registered pipelines, meshes and queued draws
+	*/
+	void RenderQueue::destroy()
+	{
+		_pipelines.clear();
+		_meshes.clear();
+		clear();
+	}
+
+	/**
+	* id of a mesh for render items, meshes are registered once and keep their id
+	*/
+	uint32_t RenderQueue::registerMesh(const Mesh* mesh)
+	{
+		std::vector<const Mesh*>::iterator it = std::find(_meshes.begin(), _meshes.end(), mesh);
+		if (it != _meshes.end())
+		{
+			return static_cast<uint32_t>(it - _meshes.begin());
+		}
+
+		if (_meshes.size() >= (1u << SortKey::meshBits))
+		{
+			throw std::runtime_error(std::format("too many meshes for the sort key, count={}", _meshes.size()));
+		}
+
+		_meshes.push_back(mesh);
+		return static_cast<uint32_t>(_meshes.size() - 1);
+	}
+
+	/**
+	* drop the draws of the previous frame
+	*/
+	void RenderQueue::clear()
+	{
+		_items.clear();
+		_entries.clear();
+	}
+
+	/**
+	* queue a draw for this frame
+	*/
+	void RenderQueue::submit(const RenderItem& item)
+	{
+		_entries.push_back(SortEntry{
+			.key = SortKey::make(item),
+			.index = static_cast<uint32_t>(_items.size()),
+		});
+		_items.push_back(item);
+	}
+
+	/**
+	* sort queued draws by key
+	*/
+	void RenderQueue::sort()
+	{
+		radixSort(_jobSystem, _entries, _scratch);
+	}
+
+	/**
+	* turn the sorted draws into draw commands, with instancing consecutive draws of equal state become one instanced draw
+	* draw i's instances start at its position in the sorted order, matching the layout written by upload
+	*/
+	void RenderQueue::buildDrawList(std::vector<DrawCommand>& drawList) const
+	{
+		drawList.clear();
+
+		uint64_t previousState = 0;
+		for (uint32_t i = 0; i < _entries.size(); i++)
+		{
+			uint64_t state = SortKey::getStateKey(_entries[i].key);
+			if (_instancing && !drawList.empty() && state == previousState)
+			{
+				drawList.back().instanceCount++;
+				continue;
+			}
+
+			drawList.push_back(DrawCommand{
+				.mesh = _meshes[SortKey::getMesh(_entries[i].key)],
+				.instanceCount = 1,
+				.pipeline = _pipelines[SortKey::getPipeline(_entries[i].key)],
+				.firstInstance = i,
+			});
+			previousState = state;
+		}
+	}
+
+	/**
+	* write instance data in sorted order to the current frame's allocator, returns the offset of the first instance in instances
+	*/
+	uint32_t RenderQueue::upload(FrameAllocator& frameAllocator)
+	{
+		if (_entries.empty())
+		{
+			return 0;
+		}
+
+		/* Aligned to the element size as well, so the offset can be expressed in instances */
+		std::optional<BufferRange> range = frameAllocator.allocate(sizeof(InstanceData) * _entries.size(), sizeof(InstanceData));
+		if (!range)
+		{
+			throw std::runtime_error(std::format("frame allocator is out of space, instances={}, used={}, capacity={}, raise frame_allocator_mb",
+				_entries.size(), frameAllocator.getUsedBytes(), frameAllocator.getCapacity()));
+		}
+
+		InstanceData* instances = static_cast<InstanceData*>(range->mapped);
+		for (size_t i = 0; i < _entries.size(); i++)
+		{
+			instances[i] = _items[_entries[i].index].instance;
+		}
+
+		return static_cast<uint32_t>(range->offset / sizeof(InstanceData));
+	}
+}
@@ -0,0 +1,123 @@
+#ifndef _ENGINE_RENDER_QUEUE_HEADER_
+#define _ENGINE_RENDER_QUEUE_HEADER_
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "ParallelRecorder.h"
+#include "../Geometry/Mesh.h"
+#include "../Memory/MemoryAllocator.h"
+#include "../Job/JobSystem.h"
+
+namespace engine
+{
+	/**
+	* Per instance data read by the vertex shader, matches Instance in vertex.glsl (std430)
+	*/
+	struct InstanceData
+	{
+		float transform[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	};
+
+	/**
+	* Draw submitted to the render queue, pipeline and mesh are ids registered with the queue
+	* depth is the normalized view depth, 0 is the near plane
+	*/
+	struct RenderItem
+	{
+		uint32_t pass = 0;
+		uint32_t pipeline = 0;
+		uint32_t material = 0;
+		uint32_t mesh = 0;
+		float depth = 0.0f;
+		InstanceData instance;
+	};
+
+	/**
+	* Bit layout of the sort key from most to least significant, draws sort by pass, then state, then front to back
+	*/
+	struct SortKey
+	{
+		static constexpr uint32_t depthBits = 24;
+		static constexpr uint32_t meshBits = 12;
+		static constexpr uint32_t materialBits = 12;
+		static constexpr uint32_t pipelineBits = 12;
+		static constexpr uint32_t passBits = 4;
+
+		static constexpr uint32_t meshShift = depthBits;
+		static constexpr uint32_t materialShift = meshShift + meshBits;
+		static constexpr uint32_t pipelineShift = materialShift + materialBits;
+		static constexpr uint32_t passShift = pipelineShift + pipelineBits;
+
+		static_assert(passShift + passBits == 64, "sort key fields have to fill 64 bits");
+
+		static uint64_t make(const RenderItem& item);
+
+		static constexpr uint32_t getPipeline(uint64_t key) { return static_cast<uint32_t>(key >> pipelineShift) & ((1u << pipelineBits) - 1); }
+		static constexpr uint32_t getMesh(uint64_t key) { return static_cast<uint32_t>(key >> meshShift) & ((1u << meshBits) - 1); }
+
+		/* Draws with equal state keys can be merged into one instanced draw */
+		static constexpr uint64_t getStateKey(uint64_t key) { return key >> depthBits; }
+	};
+
+	/**
+	* Key and submission index, the unit the radix sort moves around
+	*/
+	struct SortEntry
+	{
+		uint64_t key = 0;
+		uint32_t index = 0;
+	};
+
+	void radixSort(JobSystem* jobSystem, std::vector<SortEntry>& entries, std::vector<SortEntry>& scratch);
+
+	/**
+	* Collects the draws of a frame, sorts them by a packed 64-bit key and merges draws of equal state into instanced draws
+	* instance data is written in sorted order to the frame allocator, indexed by the draw's first instance past the upload's instance offset
+	*/
+	class RenderQueue
+	{
+	public:
+		RenderQueue() = default;
+		~RenderQueue() = default;
+
+		RenderQueue(const RenderQueue&) = delete;
+		RenderQueue& operator=(const RenderQueue&) = delete;
+
+		void init(JobSystem* jobSystem);
+		void destroy();
+
+		void setPipelines(std::vector<VkPipeline> pipelines) { _pipelines = std::move(pipelines); }
+		void setInstancing(const bool instancing) { _instancing = instancing; }
+		uint32_t registerMesh(const Mesh* mesh);
+
+		void clear();
+		void submit(const RenderItem& item);
+		void sort();
+		void buildDrawList(std::vector<DrawCommand>& drawList) const;
+		uint32_t upload(FrameAllocator& frameAllocator);
+
+		constexpr const size_t getItemCount() const { return _items.size(); }
+
+		/* Draws per sort job, smaller queues are sorted on the calling thread */
+		static constexpr size_t sortChunkSize = 16384;
+
+	protected:
+
+	private:
+		JobSystem* _jobSystem = nullptr;
+
+		std::vector<VkPipeline> _pipelines;
+		std::vector<const Mesh*> _meshes;
+		bool _instancing = false;
+
+		std::vector<RenderItem> _items;
+		std::vector<SortEntry> _entries;
+		std::vector<SortEntry> _scratch;
+	};
+}
+
+#endif // !_ENGINE_RENDER_QUEUE_HEADER_
@@ -0,0 +1,164 @@
+#include "Archetype.h"
+
+#include <new>
+#include <format>
+#include <cstring>
+#include <stdexcept>
+
+namespace engine
+{
+	/**
+	* lay out the columns of a chunk, the entity column comes first
+	*/
+	Archetype::Archetype(const ComponentMask& mask)
+		: _mask(mask)
+	{
+		_offsets.fill(UINT32_MAX);
+		_sizes.fill(0);
+
+		size_t rowSize = sizeof(Entity);
+		for (ComponentId component = 0; component < maxComponents; component++)
+		{
+			if (!mask.test(component))
+			{
+				continue;
+			}
+
+			const ComponentInfo& info = ComponentRegistry::getInfo(component);
+			if (info.alignment > columnAlignment)
+			{
+				throw std::runtime_error(std::format("component alignment exceeds column alignment, name={}, alignment={}", info.name, info.alignment));
+			}
+
+			_components.push_back(component);
+			_sizes[component] = static_cast<uint32_t>(info.size);
+			rowSize += info.size;
+		}
+
+		/* Every column may need up to a cache line of padding */
+		size_t padding = (_components.size() + 1) * columnAlignment;
+		_capacity = static_cast<uint32_t>((chunkSize - padding) / rowSize);
+		if (_capacity == 0)
+		{
+			throw std::runtime_error(std::format("archetype row does not fit a chunk, rowSize={}, chunkSize={}", rowSize, chunkSize));
+		}
+
+		size_t offset = _capacity * sizeof(Entity);
+		for (ComponentId component : _components)
+		{
+			offset = (offset + columnAlignment - 1) & ~(columnAlignment - 1);
+			_offsets[component] = static_cast<uint32_t>(offset);
+			offset += static_cast<size_t>(_capacity) * _sizes[component];
+		}
+	}
+
+	Archetype::~Archetype()
+	{
+		clear();
+	}
+
+	/**
+	* append an uninitialized row for entity, a chunk is allocated when the last one is full
+	*/
+	EntityLocation Archetype::push(Entity entity)
+	{
+		if (_chunks.empty() || _chunks.back().count == _capacity)
+		{
+			_chunks.push_back(Chunk{
+				.data = static_cast<std::byte*>(::operator new(chunkSize, std::align_val_t(columnAlignment))),
+				.count = 0,
+			});
+		}
+
+		uint32_t chunk = static_cast<uint32_t>(_chunks.size() - 1);
+		uint32_t row = _chunks[chunk].count++;
+		getEntities(chunk)[row] = entity;
+		_entityCount++;
+
+		return EntityLocation{
+			.archetype = this,
+			.chunk = chunk,
+			.row = row,
+		};
+	}
+
+	/**
+	* remove a row by moving the last row into it, returns the moved entity or an invalid one when nothing moved
+	*/
+	Entity Archetype::remove(uint32_t chunk, uint32_t row)
+	{
+		uint32_t lastChunk = static_cast<uint32_t>(_chunks.size() - 1);
+		uint32_t lastRow = _chunks[lastChunk].count - 1;
+
+		Entity moved;
+		if (chunk != lastChunk || row != lastRow)
+		{
+			for (ComponentId component : _components)
+			{
+				std::memcpy(getComponent(chunk, row, component), getComponent(lastChunk, lastRow, component), _sizes[component]);
+			}
+
+			moved = getEntities(lastChunk)[lastRow];
+			getEntities(chunk)[row] = moved;
+		}
+
+		_entityCount--;
+		if (--_chunks[lastChunk].count == 0)
+		{
+			::operator delete(_chunks[lastChunk].data, std::align_val_t(columnAlignment));
+			_chunks.pop_back();
+		}
+
+		return moved;
+	}
+
+	/**
+	* copy the components both archetypes share from source into a row of this archetype
+	*/
+	void Archetype::copyRow(const EntityLocation& source, uint32_t chunk, uint32_t row)
+	{
+		for (ComponentId component : _components)
+		{
+			if (source.archetype->_mask.test(component))
+			{
+				std::memcpy(getComponent(chunk, row, component), source.archetype->getComponent(source.chunk, source.row, component), _sizes[component]);
+			}
+		}
+	}
+
+	/**
+	* free every chunk
+	*/
+	void Archetype::clear()
+	{
+		for (Chunk& chunk : _chunks)
+		{
+			::operator delete(chunk.data, std::align_val_t(columnAlignment));
+		}
+		_chunks.clear();
+		_entityCount = 0;
+	}
+
+	/**
+	* first element of a component column, nullptr when the archetype has no such component
+	*/
+	void* Archetype::getColumn(uint32_t chunk, ComponentId component) const
+	{
+		if (component >= maxComponents || _offsets[component] == UINT32_MAX)
+		{
+			return nullptr;
+		}
+
+		return _chunks[chunk].data + _offsets[component];
+	}
+
+	/**
+	* component of a row, nullptr when the archetype has no such component
+	*/
+	void* Archetype::getComponent(uint32_t chunk, uint32_t row, ComponentId component) const
+	{
+		std::byte* column = static_cast<std::byte*>(getColumn(chunk, component));
+
+		return column == nullptr ? nullptr : column + static_cast<size_t>(row) * _sizes[component];
+	}
+}
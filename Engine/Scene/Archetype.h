@@ -0,0 +1,82 @@
+#ifndef _ENGINE_ARCHETYPE_HEADER_
+#define _ENGINE_ARCHETYPE_HEADER_
+
+#include <array>
+#include <vector>
+#include <cstddef>
+
+#include "Component.h"
+
+namespace engine
+{
+	class Archetype;
+
+	/**
+	* Row of an entity inside its archetype
+	*/
+	struct EntityLocation
+	{
+		Archetype* archetype = nullptr;
+		uint32_t chunk = 0;
+		uint32_t row = 0;
+	};
+
+	/**
+	* Fixed-size block of rows, every component is one contiguous column
+	*/
+	struct Chunk
+	{
+		std::byte* data = nullptr;
+		uint32_t count = 0;
+	};
+
+	/**
+	* Storage of every entity with exactly the same component set
+	* rows live in 16 KiB chunks as structure of arrays, columns start on cache lines
+	* rows stay dense, removing a row moves the last row of the archetype into the hole
+	*/
+	class Archetype
+	{
+	public:
+		explicit Archetype(const ComponentMask& mask);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		EntityLocation push(Entity entity);
+		Entity remove(uint32_t chunk, uint32_t row);
+		void copyRow(const EntityLocation& source, uint32_t chunk, uint32_t row);
+		void clear();
+
+		void* getColumn(uint32_t chunk, ComponentId component) const;
+		void* getComponent(uint32_t chunk, uint32_t row, ComponentId component) const;
+		Entity* getEntities(uint32_t chunk) const { return reinterpret_cast<Entity*>(_chunks[chunk].data); }
+
+		template <typename Component>
+		Component* getColumn(uint32_t chunk) const { return static_cast<Component*>(getColumn(chunk, ComponentRegistry::getId<Component>())); }
+
+		constexpr const ComponentMask& getMask() const { return _mask; }
+		constexpr const uint32_t getCapacity() const { return _capacity; }
+		constexpr const size_t getEntityCount() const { return _entityCount; }
+		uint32_t getChunkCount() const { return static_cast<uint32_t>(_chunks.size()); }
+		uint32_t getRowCount(uint32_t chunk) const { return _chunks[chunk].count; }
+
+		static constexpr size_t chunkSize = 16 * 1024;
+		static constexpr size_t columnAlignment = 64;
+
+	protected:
+
+	private:
+		ComponentMask _mask;
+		std::vector<ComponentId> _components;
+		std::array<uint32_t, maxComponents> _offsets;
+		std::array<uint32_t, maxComponents> _sizes;
+		uint32_t _capacity = 0;
+
+		std::vector<Chunk> _chunks;
+		size_t _entityCount = 0;
+	};
+}
+
+#endif // !_ENGINE_ARCHETYPE_HEADER_
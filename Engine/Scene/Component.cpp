@@ -0,0 +1,50 @@
+#include "Component.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <format>
+#include <stdexcept>
+
+namespace engine
+{
+	namespace
+	{
+		/* Written once per type under the mutex, ids are published through the function-local statics of getId */
+		std::array<ComponentInfo, maxComponents> componentInfos;
+		std::atomic<uint32_t> componentCount = 0;
+		std::mutex registryMutex;
+	}
+
+	/**
+	* layout of a registered component
+	*/
+	const ComponentInfo& ComponentRegistry::getInfo(ComponentId id)
+	{
+		if (id >= componentCount.load(std::memory_order_acquire))
+		{
+			throw std::runtime_error(std::format("unknown component, id={}", id));
+		}
+
+		return componentInfos[id];
+	}
+
+	/**
+	* store the layout of a new component type and hand out the next id
+	*/
+	ComponentId ComponentRegistry::registerComponent(const ComponentInfo& info)
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		uint32_t id = componentCount.load(std::memory_order_relaxed);
+		if (id >= maxComponents)
+		{
+			throw std::runtime_error(std::format("too many component types, max={}, name={}", maxComponents, info.name));
+		}
+
+		componentInfos[id] = info;
+		componentCount.store(id + 1, std::memory_order_release);
+
+		return id;
+	}
+}
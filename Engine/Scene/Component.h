@@ -0,0 +1,93 @@
+#ifndef _ENGINE_COMPONENT_HEADER_
+#define _ENGINE_COMPONENT_HEADER_
+
+#include <bitset>
+#include <cstdint>
+#include <typeinfo>
+#include <type_traits>
+
+namespace engine
+{
+	/**
+	* Generational handle of an entity, handles of destroyed entities never alias new ones
+	*/
+	struct Entity
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		constexpr const bool isValid() const { return index != UINT32_MAX; }
+		constexpr bool operator==(const Entity&) const = default;
+	};
+
+	using ComponentId = uint32_t;
+
+	inline constexpr uint32_t maxComponents = 64;
+	using ComponentMask = std::bitset<maxComponents>;
+
+	/**
+	* Layout of a registered component type
+	*/
+	struct ComponentInfo
+	{
+		size_t size = 0;
+		size_t alignment = 0;
+		const char* name = nullptr;
+	};
+
+	/**
+	* Assigns dense ids to component types on first use
+	* components are plain data, rows are moved between chunks with memcpy
+	*/
+	class ComponentRegistry
+	{
+	public:
+		template <typename Component>
+		static ComponentId getId();
+
+		static const ComponentInfo& getInfo(ComponentId id);
+
+	protected:
+
+	private:
+		static ComponentId registerComponent(const ComponentInfo& info);
+	};
+
+	/**
+	* id of a component type, const qualified types share the id of the plain type
+	*/
+	template <typename Component>
+	ComponentId ComponentRegistry::getId()
+	{
+		if constexpr (!std::is_same_v<Component, std::remove_cv_t<Component>>)
+		{
+			return getId<std::remove_cv_t<Component>>();
+		}
+		else
+		{
+			static_assert(std::is_trivially_copyable_v<Component>, "components must be trivially copyable");
+
+			static const ComponentId id = registerComponent(ComponentInfo{
+				.size = sizeof(Component),
+				.alignment = alignof(Component),
+				.name = typeid(Component).name(),
+			});
+
+			return id;
+		}
+	}
+
+	/**
+	* mask with the bits of every listed component set
+	*/
+	template <typename... Components>
+	ComponentMask makeComponentMask()
+	{
+		ComponentMask mask;
+		(mask.set(ComponentRegistry::getId<Components>()), ...);
+
+		return mask;
+	}
+}
+
+#endif // !_ENGINE_COMPONENT_HEADER_
@@ -0,0 +1,41 @@
+#ifndef _ENGINE_COMPONENTS_HEADER_
+#define _ENGINE_COMPONENTS_HEADER_
+
+#include <cstdint>
+
+#include "../Geometry/Mesh.h"
+
+namespace engine
+{
+	/**
+	* Placement of an object in world space
+	*/
+	struct Transform
+	{
+		float position[3] = { 0.0f, 0.0f, 0.0f };
+		float scale = 1.0f;
+	};
+
+	/**
+	* World space bounding sphere used for culling, derived from the transform
+	*/
+	struct Bounds
+	{
+		float center[3] = { 0.0f, 0.0f, 0.0f };
+		float radius = 0.0f;
+	};
+
+	/**
+	* Mesh drawn with the pipeline at index pipeline of the engine's pipeline list
+	* material is an id, draws of equal pipeline, material and mesh can be instanced together
+	*/
+	struct Renderable
+	{
+		const Mesh* mesh = nullptr;
+		uint32_t pipeline = 0;
+		uint32_t material = 0;
+		float localRadius = 1.0f;
+	};
+}
+
+#endif // !_ENGINE_COMPONENTS_HEADER_
@@ -0,0 +1,44 @@
+#include "EntityCommandBuffer.h"
+
+#include <cstring>
+
+namespace engine
+{
+	/**
+	* record destroying an entity
+	*/
+	void EntityCommandBuffer::destroyEntity(Entity entity)
+	{
+		_commands.push_back(EntityCommand{
+			.type = EntityCommandType::Destroy,
+			.entity = entity,
+		});
+	}
+
+	/**
+	* drop every recorded command
+	*/
+	void EntityCommandBuffer::clear()
+	{
+		_commands.clear();
+		_data.clear();
+	}
+
+	/**
+	* record an add and copy the component bytes, columns are written with memcpy so the data needs no alignment
+	*/
+	void EntityCommandBuffer::pushComponent(Entity entity, ComponentId component, const void* data, size_t size)
+	{
+		size_t offset = _data.size();
+		_data.resize(offset + size);
+		std::memcpy(_data.data() + offset, data, size);
+
+		_commands.push_back(EntityCommand{
+			.type = EntityCommandType::Add,
+			.entity = entity,
+			.component = component,
+			.offset = offset,
+			.size = size,
+		});
+	}
+}
@@ -0,0 +1,101 @@
+#ifndef _ENGINE_ENTITY_COMMAND_BUFFER_HEADER_
+#define _ENGINE_ENTITY_COMMAND_BUFFER_HEADER_
+
+#include <span>
+#include <vector>
+#include <cstddef>
+
+#include "Component.h"
+
+namespace engine
+{
+	enum class EntityCommandType
+	{
+		Create,
+		Destroy,
+		Add,
+		Remove,
+	};
+
+	/**
+	* Recorded structural change, a create is followed by one add per component of the new entity
+	*/
+	struct EntityCommand
+	{
+		EntityCommandType type;
+		Entity entity;
+		ComponentId component = 0;
+		uint32_t componentCount = 0;
+		size_t offset = 0;
+		size_t size = 0;
+	};
+
+	/**
+	* Records structural changes while the world is iterated, the world plays them back in recording order
+	* commands on entities destroyed before playback are dropped, entities created here get their handle at playback
+	*/
+	class EntityCommandBuffer
+	{
+	public:
+		template <typename... Components>
+		void createEntity(const Components&... components);
+		void destroyEntity(Entity entity);
+
+		template <typename Component>
+		void addComponent(Entity entity, const Component& component);
+		template <typename Component>
+		void removeComponent(Entity entity);
+
+		void clear();
+
+		std::span<const EntityCommand> getCommands() const { return _commands; }
+		const std::byte* getData(const EntityCommand& command) const { return _data.data() + command.offset; }
+		constexpr const bool isEmpty() const { return _commands.empty(); }
+
+	protected:
+
+	private:
+		std::vector<EntityCommand> _commands;
+		std::vector<std::byte> _data;
+
+		void pushComponent(Entity entity, ComponentId component, const void* data, size_t size);
+	};
+
+	/**
+	* record creation of an entity with the given components
+	*/
+	template <typename... Components>
+	void EntityCommandBuffer::createEntity(const Components&... components)
+	{
+		_commands.push_back(EntityCommand{
+			.type = EntityCommandType::Create,
+			.componentCount = static_cast<uint32_t>(sizeof...(Components)),
+		});
+
+		(pushComponent(Entity{}, ComponentRegistry::getId<Components>(), &components, sizeof(Components)), ...);
+	}
+
+	/**
+	* record adding a component, an existing component is overwritten
+	*/
+	template <typename Component>
+	void EntityCommandBuffer::addComponent(Entity entity, const Component& component)
+	{
+		pushComponent(entity, ComponentRegistry::getId<Component>(), &component, sizeof(Component));
+	}
+
+	/**
+	* record removing a component
+	*/
+	template <typename Component>
+	void EntityCommandBuffer::removeComponent(Entity entity)
+	{
+		_commands.push_back(EntityCommand{
+			.type = EntityCommandType::Remove,
+			.entity = entity,
+			.component = ComponentRegistry::getId<Component>(),
+		});
+	}
+}
+
+#endif // !_ENGINE_ENTITY_COMMAND_BUFFER_HEADER_
@@ -0,0 +1,272 @@
+#include "World.h"
+
+#include <format>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* create an entity without components
+	*/
+	Entity World::createEntity()
+	{
+		return allocateEntity(ComponentMask{});
+	}
+
+	/**
+	* destroy an entity, its handle and every copy of it become stale
+	*/
+	void World::destroyEntity(Entity entity)
+	{
+		checkStructuralChange();
+
+		getRecord(entity);
+
+		EntityRecord& record = _entities[entity.index];
+		removeRow(record.location);
+
+		record.location = EntityLocation{};
+		record.generation++;
+		_freeIndices.push_back(entity.index);
+		_entityCount--;
+	}
+
+	/**
+	* destroy every entity, archetypes are kept for the next entities
+	*/
+	void World::clear()
+	{
+		checkStructuralChange();
+
+		for (const std::unique_ptr<Archetype>& archetype : _archetypes)
+		{
+			archetype->clear();
+		}
+
+		for (uint32_t index = 0; index < _entities.size(); index++)
+		{
+			EntityRecord& record = _entities[index];
+			if (record.location.archetype != nullptr)
+			{
+				record.location = EntityLocation{};
+				record.generation++;
+				_freeIndices.push_back(index);
+			}
+		}
+
+		_entityCount = 0;
+	}
+
+	/**
+	* whether the handle refers to a live entity
+	*/
+	bool World::isAlive(Entity entity) const
+	{
+		return entity.index < _entities.size()
+			&& _entities[entity.index].generation == entity.generation
+			&& _entities[entity.index].location.archetype != nullptr;
+	}
+
+	/**
+	* apply and clear recorded structural changes, commands on dead entities are dropped
+	*/
+	void World::playback(EntityCommandBuffer& commandBuffer)
+	{
+		std::span<const EntityCommand> commands = commandBuffer.getCommands();
+
+		for (size_t i = 0; i < commands.size(); i++)
+		{
+			const EntityCommand& command = commands[i];
+			switch (command.type)
+			{
+			case EntityCommandType::Create:
+			{
+				std::span<const EntityCommand> components = commands.subspan(i + 1, command.componentCount);
+
+				ComponentMask mask;
+				for (const EntityCommand& component : components)
+				{
+					mask.set(component.component);
+				}
+
+				Entity entity = allocateEntity(mask);
+				for (const EntityCommand& component : components)
+				{
+					std::memcpy(getComponentData(entity, component.component), commandBuffer.getData(component), component.size);
+				}
+
+				i += command.componentCount;
+				break;
+			}
+			case EntityCommandType::Destroy:
+				if (isAlive(command.entity))
+				{
+					destroyEntity(command.entity);
+				}
+				break;
+			case EntityCommandType::Add:
+				if (isAlive(command.entity))
+				{
+					std::memcpy(addComponentData(command.entity, command.component), commandBuffer.getData(command), command.size);
+				}
+				break;
+			case EntityCommandType::Remove:
+				if (isAlive(command.entity))
+				{
+					removeComponentData(command.entity, command.component);
+				}
+				break;
+			}
+		}
+
+		commandBuffer.clear();
+	}
+
+	/**
+	* archetype of a component set, created on first use
+	*/
+	Archetype* World::getArchetype(const ComponentMask& mask)
+	{
+		auto found = _archetypeLookup.find(mask);
+		if (found != _archetypeLookup.end())
+		{
+			return found->second;
+		}
+
+		Archetype* archetype = _archetypes.emplace_back(std::make_unique<Archetype>(mask)).get();
+		_archetypeLookup.emplace(mask, archetype);
+
+		spdlog::debug(std::format("created archetype, components={}, capacity={}", mask.count(), archetype->getCapacity()));
+
+		return archetype;
+	}
+
+	/**
+	* hand out an entity index and append an uninitialized row to the archetype of mask
+	*/
+	Entity World::allocateEntity(const ComponentMask& mask)
+	{
+		checkStructuralChange();
+
+		Archetype* archetype = getArchetype(mask);
+
+		uint32_t index;
+		if (!_freeIndices.empty())
+		{
+			index = _freeIndices.back();
+			_freeIndices.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(_entities.size());
+			_entities.emplace_back();
+		}
+
+		EntityRecord& record = _entities[index];
+		Entity entity{
+			.index = index,
+			.generation = record.generation,
+		};
+
+		record.location = archetype->push(entity);
+		_entityCount++;
+
+		return entity;
+	}
+
+	/**
+	* move an entity to the archetype of mask, shared components are copied and the others are left uninitialized
+	*/
+	void World::moveEntity(Entity entity, const ComponentMask& mask)
+	{
+		checkStructuralChange();
+
+		EntityRecord& record = _entities[entity.index];
+		EntityLocation source = record.location;
+
+		Archetype* archetype = getArchetype(mask);
+		EntityLocation location = archetype->push(entity);
+		archetype->copyRow(source, location.chunk, location.row);
+
+		removeRow(source);
+		record.location = location;
+	}
+
+	/**
+	* remove a row and point the entity moved into it at its new location
+	*/
+	void World::removeRow(const EntityLocation& location)
+	{
+		Entity moved = location.archetype->remove(location.chunk, location.row);
+		if (moved.isValid())
+		{
+			_entities[moved.index].location = location;
+		}
+	}
+
+	/**
+	* storage of a component, the entity moves to a new archetype when it does not have the component yet
+	*/
+	void* World::addComponentData(Entity entity, ComponentId component)
+	{
+		const EntityRecord& record = getRecord(entity);
+
+		if (!record.location.archetype->getMask().test(component))
+		{
+			ComponentMask mask = record.location.archetype->getMask();
+			moveEntity(entity, mask.set(component));
+		}
+
+		return getComponentData(entity, component);
+	}
+
+	/**
+	* drop a component by moving the entity to the archetype without it
+	*/
+	void World::removeComponentData(Entity entity, ComponentId component)
+	{
+		const EntityRecord& record = getRecord(entity);
+
+		if (record.location.archetype->getMask().test(component))
+		{
+			ComponentMask mask = record.location.archetype->getMask();
+			moveEntity(entity, mask.reset(component));
+		}
+	}
+
+	/**
+	* storage of a component, nullptr when the entity does not have it
+	*/
+	void* World::getComponentData(Entity entity, ComponentId component) const
+	{
+		const EntityLocation& location = getRecord(entity).location;
+
+		return location.archetype->getComponent(location.chunk, location.row, component);
+	}
+
+	/**
+	* record of a live entity
+	*/
+	const World::EntityRecord& World::getRecord(Entity entity) const
+	{
+		if (!isAlive(entity))
+		{
+			throw std::runtime_error(std::format("entity is not alive, index={}, generation={}", entity.index, entity.generation));
+		}
+
+		return _entities[entity.index];
+	}
+
+	/**
+	* reject structural changes while chunks are iterated, they would move rows under the query
+	*/
+	void World::checkStructuralChange() const
+	{
+		if (_iterationDepth > 0)
+		{
+			throw std::runtime_error("structural change while iterating the world, record it in an entity command buffer");
+		}
+	}
+}
@@ -0,0 +1,262 @@
+#ifndef _ENGINE_WORLD_HEADER_
+#define _ENGINE_WORLD_HEADER_
+
+#include <span>
+#include <tuple>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+#include "Component.h"
+#include "Archetype.h"
+#include "EntityCommandBuffer.h"
+#include "../Job/JobSystem.h"
+
+namespace engine
+{
+	/**
+	* Rows of one chunk matched by a query, one span per queried component
+	*/
+	template <typename... Components>
+	struct ChunkView
+	{
+		std::span<const Entity> entities;
+		std::tuple<std::span<Components>...> columns;
+
+		template <typename Component>
+		std::span<Component> get() const { return std::get<std::span<Component>>(columns); }
+
+		constexpr const size_t size() const { return entities.size(); }
+	};
+
+	/**
+	* Archetype based entity-component storage
+	* entities with the same component set share an archetype, queries walk matching chunks column by column
+	* structural changes are rejected while the world is iterated, record them in an EntityCommandBuffer instead
+	*/
+	class World
+	{
+	public:
+		World() = default;
+		~World() = default;
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		Entity createEntity();
+		template <typename... Components>
+		Entity createEntity(const Components&... components);
+		void destroyEntity(Entity entity);
+		void clear();
+
+		template <typename Component>
+		void addComponent(Entity entity, const Component& component);
+		template <typename Component>
+		void removeComponent(Entity entity);
+		template <typename Component>
+		Component* getComponent(Entity entity) const;
+		template <typename Component>
+		bool hasComponent(Entity entity) const { return getComponent<Component>(entity) != nullptr; }
+		bool isAlive(Entity entity) const;
+
+		template <typename... Components, typename Function>
+		void each(Function&& function);
+		template <typename... Components, typename Function>
+		void eachChunk(Function&& function);
+		template <typename... Components, typename Function>
+		void parallelEachChunk(JobSystem& jobSystem, Function&& function, size_t grainSize = 1);
+
+		void playback(EntityCommandBuffer& commandBuffer);
+
+		constexpr const size_t getEntityCount() const { return _entityCount; }
+		size_t getArchetypeCount() const { return _archetypes.size(); }
+
+	protected:
+
+	private:
+		struct EntityRecord
+		{
+			EntityLocation location;
+			uint32_t generation = 0;
+		};
+
+		/**
+		* Marks the world as iterated for the lifetime of a query
+		*/
+		struct IterationScope
+		{
+			uint32_t& depth;
+
+			explicit IterationScope(uint32_t& iterationDepth) : depth(iterationDepth) { depth++; }
+			~IterationScope() { depth--; }
+		};
+
+		std::vector<std::unique_ptr<Archetype>> _archetypes;
+		std::unordered_map<ComponentMask, Archetype*> _archetypeLookup;
+
+		std::vector<EntityRecord> _entities;
+		std::vector<uint32_t> _freeIndices;
+		size_t _entityCount = 0;
+
+		uint32_t _iterationDepth = 0;
+		std::vector<EntityCommandBuffer> _threadCommandBuffers;
+
+		Archetype* getArchetype(const ComponentMask& mask);
+		Entity allocateEntity(const ComponentMask& mask);
+		void moveEntity(Entity entity, const ComponentMask& mask);
+		void removeRow(const EntityLocation& location);
+
+		void* addComponentData(Entity entity, ComponentId component);
+		void removeComponentData(Entity entity, ComponentId component);
+		void* getComponentData(Entity entity, ComponentId component) const;
+
+		const EntityRecord& getRecord(Entity entity) const;
+		void checkStructuralChange() const;
+
+		template <typename... Components>
+		static ChunkView<Components...> makeChunkView(const Archetype& archetype, uint32_t chunk);
+	};
+
+	/**
+	* create an entity and copy its components into the new row
+	*/
+	template <typename... Components>
+	Entity World::createEntity(const Components&... components)
+	{
+		Entity entity = allocateEntity(makeComponentMask<Components...>());
+		(std::memcpy(getComponentData(entity, ComponentRegistry::getId<Components>()), &components, sizeof(Components)), ...);
+
+		return entity;
+	}
+
+	/**
+	* add a component or overwrite the existing one, adding moves the entity to another archetype
+	*/
+	template <typename Component>
+	void World::addComponent(Entity entity, const Component& component)
+	{
+		std::memcpy(addComponentData(entity, ComponentRegistry::getId<Component>()), &component, sizeof(Component));
+	}
+
+	/**
+	* remove a component, nothing happens when the entity does not have it
+	*/
+	template <typename Component>
+	void World::removeComponent(Entity entity)
+	{
+		removeComponentData(entity, ComponentRegistry::getId<Component>());
+	}
+
+	/**
+	* component of an entity, nullptr when the entity does not have it, invalidated by structural changes
+	*/
+	template <typename Component>
+	Component* World::getComponent(Entity entity) const
+	{
+		return static_cast<Component*>(getComponentData(entity, ComponentRegistry::getId<Component>()));
+	}
+
+	/**
+	* call function(entity, components&...) for every entity having all components, chunk by chunk
+	*/
+	template <typename... Components, typename Function>
+	void World::each(Function&& function)
+	{
+		eachChunk<Components...>([&function](const ChunkView<Components...>& view)
+		{
+			std::tuple<Components*...> columns(view.template get<Components>().data()...);
+			for (size_t i = 0; i < view.size(); i++)
+			{
+				function(view.entities[i], std::get<Components*>(columns)[i]...);
+			}
+		});
+	}
+
+	/**
+	* call function(view) for every chunk of every archetype having all components
+	*/
+	template <typename... Components, typename Function>
+	void World::eachChunk(Function&& function)
+	{
+		const ComponentMask query = makeComponentMask<Components...>();
+		IterationScope scope(_iterationDepth);
+
+		for (const std::unique_ptr<Archetype>& archetype : _archetypes)
+		{
+			if ((archetype->getMask() & query) != query)
+			{
+				continue;
+			}
+
+			for (uint32_t chunk = 0; chunk < archetype->getChunkCount(); chunk++)
+			{
+				function(makeChunkView<Components...>(*archetype, chunk));
+			}
+		}
+	}
+
+	/**
+	* call function(view, commandBuffer) for matching chunks as jobs, grainSize chunks per job
+	* every job thread records into its own command buffer, they are played back in thread order once all chunks ran
+	*/
+	template <typename... Components, typename Function>
+	void World::parallelEachChunk(JobSystem& jobSystem, Function&& function, size_t grainSize)
+	{
+		const ComponentMask query = makeComponentMask<Components...>();
+
+		std::vector<std::pair<const Archetype*, uint32_t>> chunks;
+		for (const std::unique_ptr<Archetype>& archetype : _archetypes)
+		{
+			if ((archetype->getMask() & query) == query)
+			{
+				for (uint32_t chunk = 0; chunk < archetype->getChunkCount(); chunk++)
+				{
+					chunks.emplace_back(archetype.get(), chunk);
+				}
+			}
+		}
+
+		_threadCommandBuffers.resize(std::max(jobSystem.getThreadCount(), 1u));
+		for (EntityCommandBuffer& commandBuffer : _threadCommandBuffers)
+		{
+			commandBuffer.clear();
+		}
+
+		{
+			IterationScope scope(_iterationDepth);
+			jobSystem.parallelFor(0, chunks.size(), grainSize, [this, &jobSystem, &function, &chunks](size_t first, size_t last)
+			{
+				EntityCommandBuffer& commandBuffer = _threadCommandBuffers[jobSystem.getThreadIndex()];
+				for (size_t i = first; i < last; i++)
+				{
+					function(makeChunkView<Components...>(*chunks[i].first, chunks[i].second), commandBuffer);
+				}
+			});
+		}
+
+		for (EntityCommandBuffer& commandBuffer : _threadCommandBuffers)
+		{
+			playback(commandBuffer);
+		}
+	}
+
+	/**
+	* spans over the entity column and the queried component columns of a chunk
+	*/
+	template <typename... Components>
+	ChunkView<Components...> World::makeChunkView(const Archetype& archetype, uint32_t chunk)
+	{
+		size_t count = archetype.getRowCount(chunk);
+
+		return ChunkView<Components...>{
+			.entities = std::span<const Entity>(archetype.getEntities(chunk), count),
+			.columns = std::tuple<std::span<Components>...>(std::span<Components>(archetype.template getColumn<std::remove_const_t<Components>>(chunk), count)...),
+		};
+	}
+}
+
+#endif // !_ENGINE_WORLD_HEADER_
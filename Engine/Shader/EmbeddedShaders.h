@@ -0,0 +1,69 @@
+#ifndef _ENGINE_EMBEDDED_SHADERS_HEADER_
+#define _ENGINE_EMBEDDED_SHADERS_HEADER_
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace engine
+{
+	/**
+	* 64-bit FNV-1a over whole SPIR-V words, identifies a shader binary by its content
+	*/
+	constexpr uint64_t hashSpirv(std::span<const uint32_t> code)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (uint32_t word : code)
+		{
+			hash ^= word;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	/**
+	* SPIR-V compiled from resources/shader at build time, see the CustomBuild items in Engine.vcxproj
+	*/
+	namespace spirv
+	{
+		inline constexpr uint32_t vertex[] = {
+#include "vertex.spv.inc"
+		};
+
+		inline constexpr uint32_t fragment[] = {
+#include "fragment.spv.inc"
+		};
+
+		inline constexpr uint32_t vertexIndirect[] = {
+#include "vertex_indirect.spv.inc"
+		};
+
+		inline constexpr uint32_t cull[] = {
+#include "cull.spv.inc"
+		};
+	}
+
+	/**
+	* Shader binary linked into the executable
+	*/
+	struct EmbeddedShader
+	{
+		std::string_view name;
+		std::string_view source;
+		VkShaderStageFlagBits stage;
+		uint64_t hash;
+		std::span<const uint32_t> code;
+	};
+
+	inline constexpr std::array<EmbeddedShader, 4> embeddedShaders = { {
+		{ "shader/vertex.spv", "vertex.glsl", VK_SHADER_STAGE_VERTEX_BIT, hashSpirv(spirv::vertex), spirv::vertex },
+		{ "shader/fragment.spv", "fragment.glsl", VK_SHADER_STAGE_FRAGMENT_BIT, hashSpirv(spirv::fragment), spirv::fragment },
+		{ "shader/vertex_indirect.spv", "vertex_indirect.glsl", VK_SHADER_STAGE_VERTEX_BIT, hashSpirv(spirv::vertexIndirect), spirv::vertexIndirect },
+		{ "shader/cull.spv", "cull.glsl", VK_SHADER_STAGE_COMPUTE_BIT, hashSpirv(spirv::cull), spirv::cull },
+	} };
+}
+
+#endif // !_ENGINE_EMBEDDED_SHADERS_HEADER_
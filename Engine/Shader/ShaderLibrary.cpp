@@ -0,0 +1,411 @@
+#include "ShaderLibrary.h"
+
+#include <format>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+#include "../Asset/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif // _WIN32
+
+namespace engine
+{
+	namespace
+	{
+		/**
+		* glslc -fshader-stage value
+		*/
+		constexpr std::string_view getStageName(VkShaderStageFlagBits stage)
+		{
+			switch (stage)
+			{
+			case VK_SHADER_STAGE_VERTEX_BIT:
+				return "vertex";
+			case VK_SHADER_STAGE_FRAGMENT_BIT:
+				return "fragment";
+			case VK_SHADER_STAGE_COMPUTE_BIT:
+				return "compute";
+			case VK_SHADER_STAGE_GEOMETRY_BIT:
+				return "geometry";
+			case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+				return "tesscontrol";
+			case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+				return "tesseval";
+			default:
+				return "";
+			}
+		}
+
+		/**
+		* compile source with glslc, empty on failure
+		*/
+		std::optional<std::vector<uint32_t>> compileShader(const std::string& compiler, const std::filesystem::path& sourcePath, const std::filesystem::path& outputPath, VkShaderStageFlagBits stage)
+		{
+			std::string command = std::format("\"{}\" -fshader-stage={} \"{}\" -o \"{}\"", compiler, getStageName(stage), sourcePath.string(), outputPath.string());
+#ifdef _WIN32
+			/* cmd.exe strips the outer quotes of a command line that starts with one */
+			command = std::format("\"{}\"", command);
+#endif // _WIN32
+
+			if (std::system(command.c_str()) != 0)
+			{
+				spdlog::error(std::format("failed to compile shader, keeping previous binary. source={}", sourcePath.string()));
+				return std::nullopt;
+			}
+
+			std::vector<uint32_t> spirv;
+			{
+				MappedFile output(outputPath.string());
+				std::span<const std::byte> data = output.getData();
+				if (data.empty() || data.size() % sizeof(uint32_t) != 0)
+				{
+					spdlog::error(std::format("invalid compiler output, keeping previous binary. source={}", sourcePath.string()));
+					return std::nullopt;
+				}
+
+				spirv.resize(data.size() / sizeof(uint32_t));
+				std::memcpy(spirv.data(), data.data(), data.size());
+			}
+
+			std::error_code error;
+			std::filesystem::remove(outputPath, error);
+
+			return spirv;
+		}
+	}
+
+	/**
+	* register embedded shaders
+	*/
+	ShaderLibrary::ShaderLibrary()
+	{
+		for (const EmbeddedShader& shader : embeddedShaders)
+		{
+			_binaries.emplace(shader.hash, ShaderBinary{
+				.code = shader.code,
+			});
+
+			_shaders.emplace(std::string(shader.name), ShaderEntry{
+				.source = std::string(shader.source),
+				.stage = shader.stage,
+				.hash = shader.hash,
+			});
+		}
+	}
+
+	/**
+	* stop watching sources, waits for running compiles
+	*/
+	ShaderLibrary::~ShaderLibrary()
+	{
+		disableHotReload();
+	}
+
+	/**
+	* watch shader sources, changed files are recompiled on jobSystem and picked up by a later poll
+	*/
+	void ShaderLibrary::enableHotReload(const std::string_view sourceDirectory, const std::string_view compiler, JobSystem* jobSystem)
+	{
+		disableHotReload();
+
+		_sourceDirectory = sourceDirectory;
+		_compiler = compiler;
+		_jobSystem = jobSystem;
+
+#ifdef _WIN32
+		HANDLE notification = FindFirstChangeNotificationA(_sourceDirectory.string().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+		if (notification == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error(std::format("failed to watch shader sources. directory={}", _sourceDirectory.string()));
+		}
+		_notification = notification;
+
+		for (const auto& [name, entry] : _shaders)
+		{
+			std::error_code error;
+			_writeTimes[entry.source] = std::filesystem::last_write_time(_sourceDirectory / binary.source, error);
+		}
+#else
+		_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (_inotify < 0)
+		{
+			throw std::runtime_error(std::format("failed to initialize inotify"));
+		}
+
+		/* Editors save through rename as often as in place, watch both */
+		_watch = inotify_add_watch(_inotify, _sourceDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (_watch < 0)
+		{
+			disableHotReload();
+			throw std::runtime_error(std::format("failed to watch shader sources. directory={}", _sourceDirectory.string()));
+		}
+#endif // _WIN32
+
+		_hotReload = true;
+
+		spdlog::info(std::format("shader hot reload enabled, directory={}", _sourceDirectory.string()));
+	}
+
+	/**
+	* stop watching sources, reloaded binaries stay in use
+	*/
+	void ShaderLibrary::disableHotReload()
+	{
+		waitForCompiles();
+
+#ifdef _WIN32
+		if (_notification != nullptr)
+		{
+			FindCloseChangeNotification(_notification);
+		}
+		_notification = nullptr;
+		_writeTimes.clear();
+#else
+		if (_inotify >= 0)
+		{
+			close(_inotify);
+		}
+		_inotify = -1;
+		_watch = -1;
+#endif // _WIN32
+
+		_hotReload = false;
+	}
+
+	/**
+	* start compiles for changed sources and install the finished ones, returns names of shaders whose binary changed
+	*/
+	std::vector<std::string> ShaderLibrary::poll()
+	{
+		std::vector<std::string> changed;
+		if (!_hotReload)
+		{
+			return changed;
+		}
+
+		std::vector<std::string> sources = collectChangedSources();
+		for (const auto& [name, entry] : _shaders)
+		{
+			if (std::find(sources.begin(), sources.end(), entry.source) == sources.end())
+			{
+				continue;
+			}
+
+			/* A compile already in flight read the source before this change, compile again once it finished */
+			std::vector<std::unique_ptr<PendingCompile>>::iterator it = std::find_if(_pending.begin(), _pending.end(), [&name](const std::unique_ptr<PendingCompile>& pending) { return pending->name == name; });
+			if (it != _pending.end())
+			{
+				(*it)->stale = true;
+				continue;
+			}
+
+			_pending.push_back(std::make_unique<PendingCompile>());
+			_pending.back()->name = name;
+			startCompile(*_pending.back());
+		}
+
+		for (size_t i = 0; i < _pending.size();)
+		{
+			PendingCompile& pending = *_pending[i];
+			if (!pending.counter.isDone())
+			{
+				i++;
+				continue;
+			}
+
+			if (pending.stale)
+			{
+				pending.stale = false;
+				pending.spirv.reset();
+				startCompile(pending);
+				i++;
+				continue;
+			}
+
+			if (pending.spirv.has_value() && install(pending.name, std::move(*pending.spirv)))
+			{
+				changed.push_back(pending.name);
+			}
+
+			_pending.erase(_pending.begin() + i);
+		}
+
+		return changed;
+	}
+
+	/**
+	* find current binary by name
+	*/
+	std::optional<std::span<const uint32_t>> ShaderLibrary::find(const std::string_view name) const
+	{
+		std::unordered_map<std::string, ShaderEntry>::const_iterator it = _shaders.find(std::string(name));
+		if (it == _shaders.end())
+		{
+			return std::nullopt;
+		}
+
+		return find(it->second.hash);
+	}
+
+	/**
+	* find binary by content hash
+	*/
+	std::optional<std::span<const uint32_t>> ShaderLibrary::find(uint64_t hash) const
+	{
+		std::unordered_map<uint64_t, ShaderBinary>::const_iterator it = _binaries.find(hash);
+		if (it == _binaries.end())
+		{
+			return std::nullopt;
+		}
+
+		return it->second.code;
+	}
+
+	/**
+	* content hash of the current binary
+	*/
+	std::optional<uint64_t> ShaderLibrary::getHash(const std::string_view name) const
+	{
+		std::unordered_map<std::string, ShaderEntry>::const_iterator it = _shaders.find(std::string(name));
+		if (it == _shaders.end())
+		{
+			return std::nullopt;
+		}
+
+		return it->second.hash;
+	}
+
+	/**
+	* drain change notifications into a list of source file names
+	*/
+	std::vector<std::string> ShaderLibrary::collectChangedSources()
+	{
+		std::vector<std::string> sources;
+
+#ifdef _WIN32
+		if (WaitForSingleObject(_notification, 0) != WAIT_OBJECT_0)
+		{
+			return sources;
+		}
+		FindNextChangeNotification(_notification);
+
+		/* The notification does not say which file changed, compare write times */
+		for (auto& [source, writeTime] : _writeTimes)
+		{
+			std::error_code error;
+			std::filesystem::file_time_type current = std::filesystem::last_write_time(_sourceDirectory / source, error);
+			if (!error && current != writeTime)
+			{
+				writeTime = current;
+				sources.push_back(source);
+			}
+		}
+#else
+		alignas(inotify_event) char buffer[4096];
+
+		for (;;)
+		{
+			ssize_t length = read(_inotify, buffer, sizeof(buffer));
+			if (length <= 0)
+			{
+				break;
+			}
+
+			for (ssize_t offset = 0; offset < length;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				if (event->len > 0)
+				{
+					std::string source(event->name, strnlen(event->name, event->len));
+					if (std::find(sources.begin(), sources.end(), source) == sources.end())
+					{
+						sources.push_back(source);
+					}
+				}
+				offset += sizeof(inotify_event) + event->len;
+			}
+		}
+#endif // _WIN32
+
+		return sources;
+	}
+
+	/**
+	* compile on the job system, inline when it has no workers to hand the compile to
+	*/
+	void ShaderLibrary::startCompile(PendingCompile& pending)
+	{
+		const ShaderEntry& entry = _shaders.at(pending.name);
+
+		std::filesystem::path sourcePath = _sourceDirectory / entry.source;
+		std::filesystem::path outputPath = std::filesystem::temp_directory_path() / std::format("{}.{:016x}.reload.spv", entry.source, std::hash<std::string>{}(pending.name));
+		VkShaderStageFlagBits stage = entry.stage;
+
+		std::function<void()> compile = [&pending, compiler = _compiler, sourcePath, outputPath, stage]() {
+			pending.spirv = compileShader(compiler, sourcePath, outputPath, stage);
+		};
+
+		if (_jobSystem == nullptr || _jobSystem->getThreadCount() <= 1)
+		{
+			compile();
+			return;
+		}
+
+		_jobSystem->run(std::move(compile), &pending.counter);
+	}
+
+	/**
+	* block until every running compile finished and drop their results
+	*/
+	void ShaderLibrary::waitForCompiles()
+	{
+		for (std::unique_ptr<PendingCompile>& pending : _pending)
+		{
+			if (!pending->counter.isDone())
+			{
+				_jobSystem->wait(pending->counter);
+			}
+		}
+
+		_pending.clear();
+	}
+
+	/**
+	* point name at the binary with the hash of spirv, stored once per hash, returns false when the binary did not change
+	*/
+	bool ShaderLibrary::install(const std::string& name, std::vector<uint32_t>&& spirv)
+	{
+		ShaderEntry& entry = _shaders.at(name);
+
+		uint64_t hash = hashSpirv(spirv);
+		if (hash == entry.hash)
+		{
+			return false;
+		}
+
+		auto [it, inserted] = _binaries.try_emplace(hash);
+		if (inserted)
+		{
+			it->second.storage = std::move(spirv);
+			it->second.code = it->second.storage;
+		}
+
+		entry.hash = hash;
+
+		spdlog::info(std::format("reloaded shader, name={}, hash={:016x}, cached={}", name, hash, !inserted));
+
+		return true;
+	}
+}
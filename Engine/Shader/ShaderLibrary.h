@@ -0,0 +1,99 @@
+#ifndef _ENGINE_SHADER_LIBRARY_HEADER_
+#define _ENGINE_SHADER_LIBRARY_HEADER_
+
+#include <span>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+#include "EmbeddedShaders.h"
+#include "../Job/JobSystem.h"
+
+namespace engine
+{
+	/**
+	* SPIR-V stored under its content hash, embedded binaries point into the executable
+	*/
+	struct ShaderBinary
+	{
+		std::span<const uint32_t> code;
+		std::vector<uint32_t> storage;
+	};
+
+	/**
+	* Named shader, hash selects its current binary
+	*/
+	struct ShaderEntry
+	{
+		std::string source;
+		VkShaderStageFlagBits stage;
+		uint64_t hash = 0;
+	};
+
+	/**
+	* Shader binaries keyed by content hash, served from the embedded table without file I/O
+	* names resolve to the hash of their current binary, a source edited back to an earlier version reuses the stored binary
+	* with hot reload enabled, sources are watched and recompiled on the job system, a binary is swapped in by the first poll after it is ready
+	*/
+	class ShaderLibrary
+	{
+	public:
+		ShaderLibrary();
+		~ShaderLibrary();
+
+		ShaderLibrary(const ShaderLibrary&) = delete;
+		ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+		void enableHotReload(const std::string_view sourceDirectory, const std::string_view compiler, JobSystem* jobSystem);
+		void disableHotReload();
+		std::vector<std::string> poll();
+
+		std::optional<std::span<const uint32_t>> find(const std::string_view name) const;
+		std::optional<std::span<const uint32_t>> find(uint64_t hash) const;
+		std::optional<uint64_t> getHash(const std::string_view name) const;
+		constexpr const bool isHotReloadEnabled() const { return _hotReload; }
+
+	protected:
+
+	private:
+		/**
+		* Compile of one shader running on the job system, stale when its source changed again meanwhile
+		*/
+		struct PendingCompile
+		{
+			std::string name;
+			JobCounter counter;
+			std::optional<std::vector<uint32_t>> spirv;
+			bool stale = false;
+		};
+
+		std::unordered_map<uint64_t, ShaderBinary> _binaries;
+		std::unordered_map<std::string, ShaderEntry> _shaders;
+
+		bool _hotReload = false;
+		std::filesystem::path _sourceDirectory;
+		std::string _compiler;
+		JobSystem* _jobSystem = nullptr;
+		std::vector<std::unique_ptr<PendingCompile>> _pending;
+
+#ifdef _WIN32
+		void* _notification = nullptr;
+		std::unordered_map<std::string, std::filesystem::file_time_type> _writeTimes;
+#else
+		int _inotify = -1;
+		int _watch = -1;
+#endif // _WIN32
+
+		std::vector<std::string> collectChangedSources();
+		void startCompile(PendingCompile& pending);
+		void waitForCompiles();
+		bool install(const std::string& name, std::vector<uint32_t>&& spirv);
+	};
+}
+
+#endif // !_ENGINE_SHADER_LIBRARY_HEADER_
@@ -0,0 +1,376 @@
+#include "UploadQueue.h"
+
+#include <format>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace engine
+{
+	/**
+	* create timeline semaphore, per batch command pools and the staging ring
+	*/
+	void UploadQueue::init(MemoryAllocator& allocator, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, VkDeviceSize stagingSize)
+	{
+		_device = allocator.getDevice();
+		_allocator = &allocator;
+		_queue = queue;
+		_queueFamily = queueFamily;
+		_graphicsFamily = graphicsFamily;
+
+		VkSemaphoreTypeCreateInfo typeInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = 0,
+		};
+
+		VkSemaphoreCreateInfo semaphoreInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &typeInfo,
+		};
+
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_timelineSemaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to create upload timeline semaphore"));
+		}
+
+		_batches.resize(_batchCount);
+		for (UploadBatch& batch : _batches)
+		{
+			VkCommandPoolCreateInfo poolInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = _queueFamily,
+			};
+
+			if (vkCreateCommandPool(_device, &poolInfo, nullptr, &batch.commandPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to create upload command pool"));
+			}
+
+			VkCommandBufferAllocateInfo allocInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = batch.commandPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to allocate upload command buffer"));
+			}
+		}
+
+		_stagingRing.init(allocator, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _batchCount);
+		_stagingRing.beginFrame(_currentBatch);
+
+		spdlog::debug(std::format("created upload queue, family={}, graphicsFamily={}, staging={}", _queueFamily, _graphicsFamily, stagingSize));
+	}
+
+	/**
+	* wait for outstanding uploads and release resources
+	*/
+	void UploadQueue::destroy()
+	{
+		if (_device == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		wait({ _submittedValue });
+
+		_stagingRing.destroy(*_allocator);
+
+		for (const UploadBatch& batch : _batches)
+		{
+			vkDestroyCommandPool(_device, batch.commandPool, nullptr);
+		}
+		_batches.clear();
+
+		vkDestroySemaphore(_device, _timelineSemaphore, nullptr);
+		_device = VK_NULL_HANDLE;
+	}
+
+	/**
+	* copy data into a buffer range, completes at the returned ticket once flushed
+	*/
+	UploadTicket UploadQueue::uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+	{
+		BufferRange staging = allocateStaging(size, 4);
+		std::memcpy(staging.mapped, data, size);
+
+		VkCommandBuffer commandBuffer = beginBatch();
+
+		VkBufferCopy region{
+			.srcOffset = staging.offset,
+			.dstOffset = offset,
+			.size = size,
+		};
+		vkCmdCopyBuffer(commandBuffer, staging.buffer, buffer, 1, &region);
+
+		if (needsOwnershipTransfer())
+		{
+			VkBufferMemoryBarrier release{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+				.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.dstAccessMask = 0,
+				.srcQueueFamilyIndex = _queueFamily,
+				.dstQueueFamilyIndex = _graphicsFamily,
+				.buffer = buffer,
+				.offset = offset,
+				.size = size,
+			};
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &release, 0, nullptr);
+
+			VkBufferMemoryBarrier acquire = release;
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			_pendingBufferAcquires.push_back(acquire);
+		}
+
+		return { _submittedValue + 1 };
+	}
+
+	/**
+	* copy tightly packed texels into mip 0 of an image and transition it to finalLayout
+	*/
+	UploadTicket UploadQueue::uploadImage(VkImage image, VkImageAspectFlags aspectMask, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout)
+	{
+		VkDeviceSize alignment = std::max<VkDeviceSize>(16, _allocator->getLimits().optimalBufferCopyOffsetAlignment);
+		BufferRange staging = allocateStaging(size, alignment);
+		std::memcpy(staging.mapped, data, size);
+
+		VkCommandBuffer commandBuffer = beginBatch();
+
+		VkImageSubresourceRange range{
+			.aspectMask = aspectMask,
+			.baseMipLevel = 0,
+			.levelCount = 1,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		};
+
+		VkImageMemoryBarrier toTransfer{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = image,
+			.subresourceRange = range,
+		};
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region{
+			.bufferOffset = staging.offset,
+			.bufferRowLength = 0,
+			.bufferImageHeight = 0,
+			.imageSubresource = {
+				.aspectMask = aspectMask,
+				.mipLevel = 0,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+			.imageOffset = { 0, 0, 0 },
+			.imageExtent = extent,
+		};
+		vkCmdCopyBufferToImage(commandBuffer, staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		/* The layout transition happens in the release, the graphics side repeats it in the acquire */
+		VkImageMemoryBarrier release{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = 0,
+			.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			.newLayout = finalLayout,
+			.srcQueueFamilyIndex = needsOwnershipTransfer() ? _queueFamily : VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = needsOwnershipTransfer() ? _graphicsFamily : VK_QUEUE_FAMILY_IGNORED,
+			.image = image,
+			.subresourceRange = range,
+		};
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &release);
+
+		if (needsOwnershipTransfer())
+		{
+			VkImageMemoryBarrier acquire = release;
+			acquire.srcAccessMask = 0;
+			acquire.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			_pendingImageAcquires.push_back(acquire);
+		}
+
+		return { _submittedValue + 1 };
+	}
+
+	/**
+	* submit batched copies, the returned ticket covers every upload issued so far
+	*/
+	UploadTicket UploadQueue::flush()
+	{
+		UploadBatch& batch = _batches[_currentBatch];
+		if (!batch.recording)
+		{
+			return { _submittedValue };
+		}
+
+		if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to record upload command buffer"));
+		}
+
+		uint64_t signalValue = _submittedValue + 1;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo{
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.signalSemaphoreValueCount = 1,
+			.pSignalSemaphoreValues = &signalValue,
+		};
+
+		VkSubmitInfo submitInfo{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.pNext = &timelineInfo,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &batch.commandBuffer,
+			.signalSemaphoreCount = 1,
+			.pSignalSemaphores = &_timelineSemaphore,
+		};
+
+		if (vkQueueSubmit(_queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error(std::format("failed to submit upload command buffer"));
+		}
+
+		_submittedValue = signalValue;
+		batch.signalValue = signalValue;
+		batch.recording = false;
+
+		_submittedBufferAcquires.insert(_submittedBufferAcquires.end(), _pendingBufferAcquires.begin(), _pendingBufferAcquires.end());
+		_submittedImageAcquires.insert(_submittedImageAcquires.end(), _pendingImageAcquires.begin(), _pendingImageAcquires.end());
+		_pendingBufferAcquires.clear();
+		_pendingImageAcquires.clear();
+
+		advanceBatch();
+
+		return { signalValue };
+	}
+
+	/**
+	* check ticket completion without blocking
+	*/
+	bool UploadQueue::isComplete(UploadTicket ticket) const
+	{
+		uint64_t value = 0;
+		vkGetSemaphoreCounterValue(_device, _timelineSemaphore, &value);
+
+		return value >= ticket.value;
+	}
+
+	/**
+	* block until ticket completed, ticket must already be flushed
+	*/
+	void UploadQueue::wait(UploadTicket ticket) const
+	{
+		if (ticket.value == 0)
+		{
+			return;
+		}
+
+		VkSemaphoreWaitInfo waitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &_timelineSemaphore,
+			.pValues = &ticket.value,
+		};
+
+		vkWaitSemaphores(_device, &waitInfo, UINT64_MAX);
+	}
+
+	/**
+	* record queue family ownership acquires for flushed uploads into a graphics command buffer
+	* the submit of that command buffer has to wait on the timeline semaphore at getSubmittedValue()
+	*/
+	void UploadQueue::recordAcquireBarriers(VkCommandBuffer commandBuffer)
+	{
+		if (_submittedBufferAcquires.empty() && _submittedImageAcquires.empty())
+		{
+			return;
+		}
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			0, nullptr,
+			static_cast<uint32_t>(_submittedBufferAcquires.size()), _submittedBufferAcquires.data(),
+			static_cast<uint32_t>(_submittedImageAcquires.size()), _submittedImageAcquires.data());
+
+		_submittedBufferAcquires.clear();
+		_submittedImageAcquires.clear();
+	}
+
+	/**
+	* begin recording the current batch if needed
+	*/
+	VkCommandBuffer UploadQueue::beginBatch()
+	{
+		UploadBatch& batch = _batches[_currentBatch];
+		if (!batch.recording)
+		{
+			VkCommandBufferBeginInfo beginInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+				.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			};
+
+			if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS)
+			{
+				throw std::runtime_error(std::format("failed to begin upload command buffer"));
+			}
+			batch.recording = true;
+		}
+
+		return batch.commandBuffer;
+	}
+
+	/**
+	* allocate staging memory, flushes and waits for in-flight uploads when the ring is full
+	*/
+	BufferRange UploadQueue::allocateStaging(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		std::optional<BufferRange> staging = _stagingRing.allocate(size, alignment);
+		if (staging.has_value())
+		{
+			return staging.value();
+		}
+
+		flush();
+		wait({ _submittedValue });
+
+		/* Cycle through every batch so the ring reclaims all completed staging memory */
+		for (uint32_t i = 0; i < _batchCount; i++)
+		{
+			advanceBatch();
+		}
+
+		staging = _stagingRing.allocate(size, alignment);
+		if (!staging.has_value())
+		{
+			throw std::runtime_error(std::format("upload exceeds staging ring capacity, size={}, capacity={}", size, _stagingRing.getCapacity()));
+		}
+
+		return staging.value();
+	}
+
+	/**
+	* move to the next batch, waiting until its previous submission finished
+	*/
+	void UploadQueue::advanceBatch()
+	{
+		_currentBatch = (_currentBatch + 1) % _batchCount;
+
+		UploadBatch& batch = _batches[_currentBatch];
+		wait({ batch.signalValue });
+
+		vkResetCommandPool(_device, batch.commandPool, 0);
+		_stagingRing.beginFrame(_currentBatch);
+	}
+}
@@ -0,0 +1,91 @@
+#ifndef _ENGINE_UPLOAD_QUEUE_HEADER_
+#define _ENGINE_UPLOAD_QUEUE_HEADER_
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "../Memory/MemoryAllocator.h"
+
+namespace engine
+{
+	/**
+	* Timeline semaphore value an upload completes at
+	*/
+	struct UploadTicket
+	{
+		uint64_t value = 0;
+	};
+
+	/**
+	* Command buffer batching copies until the next flush
+	*/
+	struct UploadBatch
+	{
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		uint64_t signalValue = 0;
+		bool recording = false;
+	};
+
+	/**
+	* Asynchronous uploads through a persistently mapped staging ring on the transfer queue
+	* copies are batched and submitted on flush, completion is signaled on a timeline semaphore
+	*/
+	class UploadQueue
+	{
+	public:
+		UploadQueue() = default;
+		~UploadQueue() = default;
+
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue& operator=(const UploadQueue&) = delete;
+
+		void init(MemoryAllocator& allocator, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, VkDeviceSize stagingSize);
+		void destroy();
+
+		UploadTicket uploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+		UploadTicket uploadImage(VkImage image, VkImageAspectFlags aspectMask, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout);
+
+		UploadTicket flush();
+
+		bool isComplete(UploadTicket ticket) const;
+		void wait(UploadTicket ticket) const;
+
+		void recordAcquireBarriers(VkCommandBuffer commandBuffer);
+
+		constexpr const VkSemaphore getTimelineSemaphore() const { return _timelineSemaphore; }
+		constexpr const uint64_t getSubmittedValue() const { return _submittedValue; }
+
+	protected:
+
+	private:
+		VkDevice _device = VK_NULL_HANDLE;
+		MemoryAllocator* _allocator = nullptr;
+		VkQueue _queue = VK_NULL_HANDLE;
+		uint32_t _queueFamily = 0;
+		uint32_t _graphicsFamily = 0;
+
+		VkSemaphore _timelineSemaphore = VK_NULL_HANDLE;
+		uint64_t _submittedValue = 0;
+
+		RingPool _stagingRing;
+		std::vector<UploadBatch> _batches;
+		uint32_t _currentBatch = 0;
+
+		std::vector<VkBufferMemoryBarrier> _pendingBufferAcquires;
+		std::vector<VkImageMemoryBarrier> _pendingImageAcquires;
+		std::vector<VkBufferMemoryBarrier> _submittedBufferAcquires;
+		std::vector<VkImageMemoryBarrier> _submittedImageAcquires;
+
+		static constexpr uint32_t _batchCount = 4;
+
+		constexpr const bool needsOwnershipTransfer() const { return _queueFamily != _graphicsFamily; }
+
+		VkCommandBuffer beginBatch();
+		BufferRange allocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+		void advanceBatch();
+	};
+}
+
+#endif // !_ENGINE_UPLOAD_QUEUE_HEADER_
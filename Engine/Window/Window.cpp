@@ -2,7 +2,7 @@
 
 #include <iostream>
 #include <format>
-#include <thread>
+#include <chrono>
 
 #include <SDL3/SDL_vulkan.h>
 #include <spdlog/spdlog.h>
@@ -26,51 +26,121 @@ Window::~Window()
 }
 
 /**
-* Initialize and create window
+* Apply the [window] section and the main loop keys of the config
+*/
+void Window::configure(const INIReader& reader)
+{
+	setTitle(reader.GetString("window", "title", "window"));
+	setWidth(reader.GetInteger("window", "width", 640));
+	setHeight(reader.GetInteger("window", "height", 480));
+	setFrameStatsPath(reader.GetString("engine", "frame_stats_csv", "frame_stats.csv"));
+	setFrameLimit(reader.GetInteger("engine", "frame_limit", 0));
+}
+
+/**
+* Initialize engine and create window, independent stages run concurrently on the job system
 */
 void Window::init()
 {
+	engine::Engine* engine = engine::Engine::getInstance();
+	engine->createJobSystem();
+	engine->createProfiler();
+
+	engine::StartupGraph startup;
+
+	/* SDL video and window handling stay on the main thread */
+	startup.add("sdl", [engine]() { engine->initSDL(); }, {}, engine::StageThread::Main);
+	startup.add("window", [this, engine]() { createWindow(); engine->setSDLWindow(_window); }, { "sdl" }, engine::StageThread::Main);
+	startup.add("sdl subsystems", [engine]() { engine->initSDLSubsystems(); }, { "window" }, engine::StageThread::Main);
+
+	/* File I/O, no device needed */
+	startup.add("asset pack", [engine]() { engine->openAssetPack(); });
+	startup.add("shader library", [engine]() { engine->createShaderLibrary(); });
+	startup.add("pipeline cache data", [engine]() { engine->loadPipelineCacheData(); });
+	startup.add("extensions", [engine]() { engine->searchExtensions(); });
+
+	startup.add("instance", [engine]() { engine->createInstance(); }, { "sdl" });
+	startup.add("debug messenger", [engine]() { engine->setupDebugMessenger(); }, { "instance" });
+	startup.add("surface", [engine]() { engine->createSurface(); }, { "debug messenger", "window" }, engine::StageThread::Main);
+	startup.add("physical device", [engine]() { engine->selectPhysicalDevice(); }, { "surface" });
+	startup.add("logical device", [engine]() { engine->createLogicalDevice(); }, { "physical device" });
+
+	startup.add("memory allocator", [engine]() { engine->createMemoryAllocator(); }, { "logical device" });
+	startup.add("upload queue", [engine]() { engine->createUploadQueue(); }, { "memory allocator" });
+	startup.add("compute queue", [engine]() { engine->createComputeQueue(); }, { "logical device" });
+	startup.add("gpu profilers", [engine]() { engine->createGpuProfilers(); }, { "compute queue" });
+	startup.add("pipeline cache", [engine]() { engine->createPipelineCache(); }, { "logical device", "pipeline cache data" });
+	startup.add("swap chain", [engine]() { engine->createSwapChain(); }, { "logical device" }, engine::StageThread::Main);
+	startup.add("image views", [engine]() { engine->createImageview(); }, { "swap chain" });
+	startup.add("render pass", [engine]() { engine->createRenderPass(); }, { "swap chain" });
+	startup.add("bindless heap", [engine]() { engine->createBindlessHeap(); }, { "logical device" });
+	startup.add("frame allocator", [engine]() { engine->createFrameAllocator(); }, { "memory allocator", "bindless heap" });
+	startup.add("render graph", [engine]() { engine->createRenderGraph(); }, { "memory allocator" });
+	startup.add("render queue", [engine]() { engine->createRenderQueue(); });
+	startup.add("indirect renderer", [engine]() { engine->createIndirectRenderer(); }, { "memory allocator", "bindless heap", "pipeline cache", "shader library", "asset pack" });
+	startup.add("graphics pipeline", [engine]() { engine->createGraphicsPipeline(); }, { "render pass", "pipeline cache", "shader library", "asset pack", "render queue", "indirect renderer" });
+	startup.add("framebuffers", [engine]() { engine->createFrameBuffer(); }, { "image views", "render pass" });
+	startup.add("geometry", [engine]() { engine->createGeometry(); }, { "graphics pipeline", "upload queue", "gpu profilers" });
+	startup.add("frame resources", [engine]() { engine->createFrameResources(); }, { "swap chain" });
+	startup.add("record benchmark", [engine]() { engine->benchmarkRecording(); }, { "geometry", "framebuffers", "frame resources", "frame allocator" }, engine::StageThread::Main);
+
+	startup.setSerial(_serialStartup);
+	startup.run(engine->getJobSystem());
+	_startupTimings = startup.getTimings();
+
+	_stop = true;
+}
+
+/**
+* Create SDL window, headless runs only hand their size to the engine
+*/
+void Window::createWindow()
+{
+	engine::Engine* engine = engine::Engine::getInstance();
+	if (engine->isHeadless())
+	{
+		engine->setHeadlessExtent(_width, _height);
+		return;
+	}
+
 	_window = SDL_CreateWindow(
 		_title.data(),
 		SDL_WINDOWPOS_CENTERED,
 		SDL_WINDOWPOS_CENTERED,
 		_width,
 		_height,
-		SDL_WINDOW_VULKAN | SDL_WINDOW_ALLOW_HIGHDPI
+		SDL_WINDOW_VULKAN | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_RESIZABLE
 	);
 
-	_stop = true;
-
 	if (_window == nullptr)
 	{
 		throw std::runtime_error(std::format("Failed to initialize window: {}", SDL_GetError()));
 	}
-
-	engine::Engine::getInstance()->setSDLWindow(_window);
-	engine::Engine::getInstance()->createInstance();
-	engine::Engine::getInstance()->setupDebugMessenger();
-	engine::Engine::getInstance()->searchExtensions();
-	engine::Engine::getInstance()->createSurface();
-	engine::Engine::getInstance()->selectPhysicalDevice();
-	engine::Engine::getInstance()->createLogicalDevice();
-	engine::Engine::getInstance()->createSwapChain();
-	engine::Engine::getInstance()->createImageview();
-	engine::Engine::getInstance()->createRenderPass();
-	engine::Engine::getInstance()->createGraphicsPipeline();
-	engine::Engine::getInstance()->createFrameBuffer();
 }
 
 /**
-* Run window gameloop
+* Run window gameloop, timings of every presented frame go to the frame statistics
 */
 void Window::run()
 {
 	_stop = false;
 
+	bool headless = engine::Engine::getInstance()->isHeadless();
+	uint64_t presentedFrames = 0;
+
 	SDL_Event event;
 	while (!_stop)
 	{
-		while (SDL_PollEvent(&event))
+		/* Block on events while minimized instead of spinning on an empty swap chain */
+		if (_minimized && SDL_WaitEvent(nullptr) == 0)
+		{
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point frameBegin = std::chrono::steady_clock::now();
+
+		/* There is no event source without a window */
+		while (!headless && SDL_PollEvent(&event))
 		{
 			switch (event.type)
 			{
@@ -78,10 +148,70 @@ void Window::run()
 				_stop = true;
 				break;
 
+			case SDL_WINDOWEVENT_MINIMIZED:
+				_minimized = true;
+				break;
+
+			case SDL_WINDOWEVENT_RESTORED:
+			case SDL_WINDOWEVENT_MAXIMIZED:
+				_minimized = false;
+				engine::Engine::getInstance()->setFramebufferResized();
+				break;
+
+			case SDL_WINDOWEVENT_SIZE_CHANGED:
+				engine::Engine::getInstance()->setFramebufferResized();
+				break;
+
+			case SDL_KEYDOWN:
+				if (event.key.keysym.sym == _frameStatsKey && !event.key.repeat)
+				{
+					dumpFrameStats();
+				}
+				break;
+
 			default:
 				break;
 			}
 		}
+
+		if (!_minimized && !_stop && engine::Engine::getInstance()->drawFrame())
+		{
+			engine::FrameTiming timing = engine::Engine::getInstance()->getFrameTiming();
+			timing.cpu = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameBegin).count();
+			_frameStats.push(timing);
+
+			if (_frameLimit > 0 && ++presentedFrames >= _frameLimit)
+			{
+				spdlog::info(std::format("reached frame limit, frames={}", presentedFrames));
+				_stop = true;
+			}
+		}
+	}
+
+	engine::Engine::getInstance()->waitIdle();
+
+	dumpFrameStats();
+}
+
+/**
+* log frame time percentiles and write them as CSV when a path is configured
+*/
+void Window::dumpFrameStats()
+{
+	_frameStats.logSummary();
+
+	if (_frameStatsPath.empty())
+	{
+		return;
+	}
+
+	try
+	{
+		_frameStats.writeCsv(_frameStatsPath);
+	}
+	catch (const std::exception& e)
+	{
+		spdlog::error(std::format("{}", e.what()));
 	}
 }
 
@@ -100,6 +230,7 @@ void Window::setWidth(const int width)
 
 		SDL_Vulkan_GetDrawableSize(_window, &width, &height);
 		SDL_SetWindowSize(_window, _width, height);
+		engine::Engine::getInstance()->setFramebufferResized();
 	}
 }
 
@@ -118,6 +249,7 @@ void Window::setHeight(const int height)
 
 		SDL_Vulkan_GetDrawableSize(_window, &width, &height);
 		SDL_SetWindowSize(_window, width, _height);
+		engine::Engine::getInstance()->setFramebufferResized();
 	}
 }
 
@@ -5,6 +5,10 @@
 #include <vector>
 
 #include <SDL3/SDL.h>
+#include <INIReader.h>
+
+#include "../Profile/FrameStats.h"
+#include "../Job/StartupGraph.h"
 
 class Window
 {
@@ -15,18 +19,25 @@ public:
 	Window(const Window&) = delete;
 	Window& operator=(const Window&) = delete;
 
+	void configure(const INIReader& reader);
 	void init();
 	void run();
 
 	void setWidth(const int width);
 	void setHeight(const int height);
 	void setTitle(const std::string_view title);
+	void setFrameStatsPath(const std::string_view path) { _frameStatsPath = path; }
+	void setSerialStartup(const bool serial) { _serialStartup = serial; }
+	void setFrameLimit(const int frameLimit) { _frameLimit = frameLimit <= 0 ? 0 : static_cast<uint64_t>(frameLimit); }
 
 	constexpr const int getWidth() const { return _width; }
 	constexpr const int getHeight() const { return _height; }
 	constexpr const std::string_view getTitle() const { return _title; }
 	constexpr const SDL_Window* getWindow() const { return _window; }
 	constexpr const bool isStop() const { return _stop; }
+	constexpr const bool isMinimized() const { return _minimized; }
+	const engine::FrameStats& getFrameStats() const { return _frameStats; }
+	const std::vector<engine::StageTiming>& getStartupTimings() const { return _startupTimings; }
 
 protected:
 
@@ -34,11 +45,24 @@ private:
 	SDL_Window* _window;
 
 	bool _stop = false;
+	bool _minimized = false;
 
 	int _width = 640;
 	int _height = 480;
 
 	std::string _title = "window";
+
+	engine::FrameStats _frameStats;
+	std::string _frameStatsPath;
+	uint64_t _frameLimit = 0;
+
+	bool _serialStartup = false;
+	std::vector<engine::StageTiming> _startupTimings;
+
+	static constexpr SDL_Keycode _frameStatsKey = SDLK_F12;
+
+	void createWindow();
+	void dumpFrameStats();
 };
 
 #endif // !_ENGINE_WINDOW_HEADER_
@@ -2,6 +2,8 @@
 #include <vector>
 #include <exception>
 #include <format>
+#include <cstdlib>
+#include <string_view>
 
 #include <SDL3/SDL_main.h>
 #include <spdlog/spdlog.h>
@@ -14,32 +16,56 @@ int main(int argc, char* argv[])
 {
 	try
 	{
-		engine::Engine::getInstance();
+		/* Torn down in reverse order by ServiceRegistry::shutdown */
+		ServiceRegistry::registerService<IniReader>();
+		ServiceRegistry::registerService<engine::Profiler>();
+		ServiceRegistry::registerService<engine::Engine>();
 	}
 	catch (const std::exception& e)
 	{
 		spdlog::error(std::format("{}", e.what()));
+		ServiceRegistry::shutdown();
 		return EXIT_FAILURE;
 	}
 
 	Window* window = new Window();
-	window->setTitle(IniReader::getInstance()->getReader().GetString("window", "title", "window"));
-	window->setWidth(IniReader::getInstance()->getReader().GetInteger("window", "width", 640));
-	window->setHeight(IniReader::getInstance()->getReader().GetInteger("window", "height", 480));
 
 	try
 	{
+		/* Config values are parsed here, a typo in config.ini throws */
+		window->configure(IniReader::getInstance()->getReader());
+		engine::Engine::getInstance()->configure(IniReader::getInstance()->getReader());
+
+		/* Command line overrides the config, e.g. --headless --frames 600 for unattended runs */
+		for (int i = 1; i < argc; i++)
+		{
+			std::string_view argument = argv[i];
+			if (argument == "--headless")
+			{
+				engine::Engine::getInstance()->setHeadless(true);
+			}
+			else if (argument == "--frames" && i + 1 < argc)
+			{
+				window->setFrameLimit(std::atoi(argv[++i]));
+			}
+			else
+			{
+				spdlog::warn(std::format("ignoring unknown argument, argument={}", argument));
+			}
+		}
+
 		window->init();
 	}
 	catch (const std::exception& e)
 	{
 		spdlog::error(std::format("{}", e.what()));
+		ServiceRegistry::shutdown();
 		return EXIT_FAILURE;
 	}
 
 	window->run();
 
-	engine::Engine::destoryInstance();
+	ServiceRegistry::shutdown();
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct Object {
+    vec4 sphere;
+    vec4 transform;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint batch;
+};
+
+struct Batch {
+    uint commandOffset;
+    uint capacity;
+};
+
+struct DrawCommand {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects {
+    Object objects[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Batches {
+    Batch batches[];
+};
+
+layout(std430, set = 0, binding = 2) writeonly buffer Commands {
+    DrawCommand commands[];
+};
+
+layout(std430, set = 0, binding = 3) buffer Counts {
+    uint counts[];
+};
+
+layout(push_constant) uniform Cull {
+    vec4 planes[6];
+    uint objectCount;
+};
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount) {
+        return;
+    }
+
+    Object object = objects[index];
+    for (int i = 0; i < 6; i++) {
+        if (dot(planes[i].xyz, object.sphere.xyz) + planes[i].w < -object.sphere.w) {
+            return;
+        }
+    }
+
+    // firstInstance carries the object index to the vertex shader
+    uint slot = atomicAdd(counts[object.batch], 1);
+    commands[batches[object.batch].commandOffset + slot] = DrawCommand(object.indexCount, 1, object.firstIndex, object.vertexOffset, index);
+}
\ No newline at end of file
@@ -1,20 +1,28 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+struct Instance {
+    vec4 transform;
+};
+
+// Bindless storage buffers, the push constants select the one holding this draw's instances
+layout(std430, set = 0, binding = 2) readonly buffer Instances {
+    Instance instances[];
+} instanceBuffers[];
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(push_constant) uniform Draw {
+    mat4 viewProjection;
+    uint instanceBuffer;
+    uint instanceOffset;
+};
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    Instance instance = instanceBuffers[instanceBuffer].instances[instanceOffset + gl_InstanceIndex];
+    gl_Position = viewProjection * vec4(inPosition * instance.transform.w + instance.transform.xyz, 1.0);
+    fragColor = inColor;
 }
\ No newline at end of file
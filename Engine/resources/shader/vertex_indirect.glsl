@@ -0,0 +1,33 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+struct Object {
+    vec4 sphere;
+    vec4 transform;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint batch;
+};
+
+// Bindless storage buffers, the push constants select the object buffer
+layout(std430, set = 0, binding = 2) readonly buffer Objects {
+    Object objects[];
+} objectBuffers[];
+
+layout(push_constant) uniform Draw {
+    mat4 viewProjection;
+    uint instanceBuffer;
+    uint instanceOffset;
+};
+
+void main() {
+    Object object = objectBuffers[instanceBuffer].objects[gl_InstanceIndex];
+    gl_Position = viewProjection * vec4(inPosition * object.transform.w + object.transform.xyz, 1.0);
+    fragColor = inColor;
+}
\ No newline at end of file